@@ -1,14 +1,63 @@
 // 1D Random Walk Generator using PCG32 PRNG
-// Build: gcc main_dat.c seed_generator.c -o program_dat -lm
+// Build: gcc main_dat.c seed_generator.c ../../common/src/rec_writer.c
+//            ../../common/src/out_backend.c -o program_dat -lm -pthread
+// Usage: program_dat <runs> <iterations> [antithetic=1]
+//                    [ctrw=exp|pareto] [alpha=0.5] [tau0=1] [levy=alpha]
+//                    [steps=spec]
+//
+// antithetic=1: each run's random stream also drives a mirrored partner walk
+// that takes the opposite sign on every odd step. With E and O the sums of
+// the even and odd steps, the pair is x = E + O, x' = E - O, so both walks
+// are exact random walks and x^2, x'^2 are (slightly negatively) correlated
+// at every t. The pair is one sample of the estimator
+// (x^2 + x'^2) / 2 = E^2 + O^2, which keeps the error bars of x2_mean.dat
+// correct; runs counts pairs, i.e. 2 * runs walks for the RNG cost of runs.
+//
+// ctrw=...: continuous-time random walk. Each walker waits a random time
+// between its +-1 steps: exponential with mean tau0 (ctrw=exp, ziggurat
+// sampler; same <x^2(t)> = t / tau0 as the unit-step walk) or Pareto,
+// psi(tau) = alpha tau0^alpha / tau^(1 + alpha) for tau >= tau0 (ctrw=pareto,
+// table-driven inverse CDF), which is subdiffusive for alpha < 1:
+// <x^2(t)> ~ (t / tau0)^alpha sin(pi alpha) / (pi alpha). All runs walk
+// together, event by event, ordered by a bucket queue of next-event times
+// over the wall times t = 1..iterations. sum x^2 and sum x^4 over the
+// walkers are kept up to date at every event, so line t - 1 of x2_mean.dat
+// (the grid of the unit-step walk) costs O(1).
+// ran_gen.dat then holds the first walker sampled at the wall times.
+//
+// levy=alpha: Levy flight, jumps of integer Pareto length L (P(L >= l) =
+// l^-alpha, common/levy.h) in a random direction, drawn in batches of
+// LEVY_BATCH. <x^2> is infinite for alpha < 2, so instead of x2_mean.dat
+// the runs write levy_1d.dat: mean of ln(1 + |x|) and quantiles of |x| at
+// log-spaced times (no trajectory file).
+//
+// steps=spec: unit-step runs with any finite step distribution, e.g.
+// "1:3,-1:1" (drift) or "1:1,-1:1,2:1,-2:1", sampled from an alias table
+// with one draw per step (common/step_dist.h). iterations * max |dx| must
+// not exceed X_REACH, so that x^2 fits the int64_t sums.
 
+#include "../../common/include/cli_opts.h"
+#include "../../common/include/exact_acc.h"
+#include "../../common/include/fast_fmt.h"
+#include "../../common/include/levy.h"
+#include "../../common/include/rec_writer.h"
+#include "../../common/include/step_dist.h"
 #include "../include/seed_generator.h"
+#include <math.h>
 #include <stdint.h>
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h> // for getpid()
 
+#define ZIG_LAYERS 256             // exponential ziggurat layers
+#define ZIG_R 7.69711747013104972  // start of the exponential tail
+#define ZIG_V 3.949659822581572e-3 // area of every layer
+#define PARETO_TABLE 1024          // u^(-1/alpha) table over u in [1/2, 1)
+#define X_REACH 3037000499LL       // |x| <= X_REACH keeps x^2 in int64_t
+
 //=======================================================
 //  UTILITY FUNCTIONS
 //=======================================================
@@ -51,6 +100,185 @@ void pcg32_srandom_r(pcg32_random_t *rng, uint64_t initstate,
 
 pcg32_random_t pcg32_random_state;
 
+// Trajectory line "%d %d %d %d\n" (i x x^2 time) from a record (i, x);
+// time equals i
+static size_t format_traj(char *out, const spsc_record_t *rec,
+                          const void *ctx) {
+  (void)ctx;
+  int i = (int)rec->v[0];
+  int64_t position = rec->v[1];
+  size_t n = fmt_i64(out, i);
+  out[n++] = ' ';
+  n += fmt_i64(out + n, position);
+  out[n++] = ' ';
+  n += fmt_i64(out + n, position * position);
+  out[n++] = ' ';
+  n += fmt_i64(out + n, i);
+  out[n++] = '\n';
+  return n;
+}
+
+//=======================================================
+//  WAITING TIMES
+//=======================================================
+
+// Exponential ziggurat (Marsaglia & Tsang 2000): 8 bits of a draw pick the
+// layer, the other 24 the abscissa; only ~1.2% of draws need exp() or log().
+// Layer i of width w[i] holds the points x = j * w[i] with j < k[i] entirely
+// under the density.
+static uint32_t zig_k[ZIG_LAYERS];
+static double zig_w[ZIG_LAYERS], zig_f[ZIG_LAYERS];
+
+static void zig_init(void) {
+  const double m = 16777216.0; // 2^24
+  double d = ZIG_R, t = d, q = ZIG_V / exp(-d);
+  zig_k[0] = (uint32_t)(d / q * m);
+  zig_k[1] = 0;
+  zig_w[0] = q / m;
+  zig_w[ZIG_LAYERS - 1] = d / m;
+  zig_f[0] = 1.0;
+  zig_f[ZIG_LAYERS - 1] = exp(-d);
+  for (int i = ZIG_LAYERS - 2; i >= 1; i--) {
+    d = -log(ZIG_V / d + exp(-d));
+    zig_k[i + 1] = (uint32_t)(d / t * m);
+    t = d;
+    zig_f[i] = exp(-d);
+    zig_w[i] = d / m;
+  }
+}
+
+// uniform in (0, 1]
+static inline double unit_r(pcg32_random_t *rng) {
+  return ((double)pcg32_random_r(rng) + 1.0) / ((double)UINT32_MAX + 1.0);
+}
+
+// Exponential variate with mean 1
+static double zig_exp(pcg32_random_t *rng) {
+  for (;;) {
+    uint32_t r = pcg32_random_r(rng);
+    uint32_t i = r & (ZIG_LAYERS - 1), j = r >> 8;
+    double x = j * zig_w[i];
+    if (j < zig_k[i])
+      return x; // inside the layer's rectangle
+    if (i == 0)
+      return ZIG_R - log(unit_r(rng)); // tail: memoryless restart at R
+    if (zig_f[i] + unit_r(rng) * (zig_f[i - 1] - zig_f[i]) < exp(-x))
+      return x; // wedge accept
+  }
+}
+
+static double exp_tau0 = 1.0; // mean of the exponential waiting times
+
+static double exp_wait(pcg32_random_t *rng) { return exp_tau0 * zig_exp(rng); }
+
+// Pareto inverse CDF tau0 u^(-1/alpha): with u = m 2^-e, m in [1/2, 1), it
+// is 2^(e/alpha) * m^(-1/alpha), both factors tabulated (the second with
+// linear interpolation; the relative error grows as (1/alpha)(1/alpha + 1)
+// / PARETO_TABLE^2: 7.2e-7 at alpha = 0.5, 1.3e-5 at alpha = 0.1)
+static double pareto_pow2[33], pareto_m[PARETO_TABLE + 1];
+
+static void pareto_init(double alpha, double tau0) {
+  for (int e = 0; e <= 32; e++)
+    pareto_pow2[e] = tau0 * pow(2.0, e / alpha);
+  for (int k = 0; k <= PARETO_TABLE; k++)
+    pareto_m[k] = pow(0.5 + 0.5 * k / PARETO_TABLE, -1.0 / alpha);
+}
+
+static double pareto_wait(pcg32_random_t *rng) {
+  uint32_t r = pcg32_random_r(rng);
+  if (r == 0)
+    return pareto_pow2[0]; // u = 1
+  uint32_t u = -r; // u = (2^32 - r) / 2^32 in (0, 1)
+  int e = __builtin_clz(u);
+  uint32_t m = u << e; // mantissa in [2^31, 2^32)
+  uint32_t k = (m >> 21) & (PARETO_TABLE - 1);
+  double frac = (double)(m & ((1u << 21) - 1)) / (double)(1u << 21);
+  return pareto_pow2[e] *
+         (pareto_m[k] + frac * (pareto_m[k + 1] - pareto_m[k]));
+}
+
+//=======================================================
+//  CONTINUOUS-TIME ENSEMBLE
+//=======================================================
+
+typedef struct {
+  double next; // time of the walker's next step
+  int position;
+  int link;           // next walker in the same bucket, -1 = last
+  pcg32_random_t rng; // the run's stream (same seeds as the unit-step runs)
+} ctrw_walker_t;
+
+// File walker i under the first wall time t >= its next step (if any); a
+// step at exactly 0 (zig_exp can return 0) goes to t = 1 with (0, 1]
+static inline void bucket_push(int *bucket, int iterations, ctrw_walker_t *w,
+                               int i) {
+  if (w[i].next > iterations)
+    return; // no more steps inside the simulated window
+  int t = (int)ceil(w[i].next);
+  if (t < 1)
+    t = 1; // bucket[0] is never visited
+  w[i].link = bucket[t];
+  bucket[t] = i;
+}
+
+// All runs advanced together; x2_acc[t - 1] gets the ensemble at wall time
+// t = 1..iterations. The next-event queue is a bucket (calendar) queue over
+// the wall-time grid: bucket[t] lists the walkers whose next step falls in
+// (t - 1, t]. Walkers are independent, so the order of events inside one
+// interval does not matter; each popped walker takes all of its steps up
+// to t at once and is filed under a later bucket, O(1) per event.
+static int run_ctrw(int runs, int iterations, int pareto, exact_acc_t *x2_acc,
+                    spsc_ring_t *ring, int traj_sink) {
+  ctrw_walker_t *w = malloc((size_t)runs * sizeof(*w));
+  int *bucket = malloc(((size_t)iterations + 1) * sizeof(*bucket));
+  if (!w || !bucket) {
+    free(w);
+    free(bucket);
+    return handle_mem_err();
+  }
+  for (int t = 0; t <= iterations; t++)
+    bucket[t] = -1;
+  double (*wait)(pcg32_random_t *) = pareto ? pareto_wait : exp_wait;
+  for (int run = 0; run < runs; run++) {
+    unsigned int seed1 = generate_seed();
+    unsigned int seed2 = generate_seed();
+    pcg32_srandom_r(&w[run].rng, (uint64_t)seed1, (uint64_t)seed2);
+    w[run].position = 0;
+    w[run].next = wait(&w[run].rng);
+    bucket_push(bucket, iterations, w, run);
+  }
+
+  int64_t s2 = 0;  // sum of x^2 over the walkers
+  __int128 s4 = 0; // sum of x^4
+  long events = 0;
+  for (int t = 1; t <= iterations; t++) {
+    int i = bucket[t];
+    while (i >= 0) {
+      ctrw_walker_t *v = &w[i];
+      int later = v->link;
+      int64_t old2 = (int64_t)v->position * v->position;
+      do {
+        v->position += (pcg32_random_r(&v->rng) >> 31) ? 1 : -1;
+        v->next += wait(&v->rng);
+        events++;
+      } while (v->next <= t);
+      int64_t new2 = (int64_t)v->position * v->position;
+      s2 += new2 - old2;
+      s4 += (__int128)new2 * new2 - (__int128)old2 * old2;
+      bucket_push(bucket, iterations, w, i);
+      i = later;
+    }
+    exact_acc_t snap = {runs, s2, s4};
+    exact_acc_merge(&x2_acc[t - 1], &snap);
+    rw_push(ring, traj_sink, t - 1, w[0].position, 0);
+  }
+  printf("CTRW: %ld events of %d walkers up to t = %d\n", events, runs,
+         iterations);
+  free(w);
+  free(bucket);
+  return EXIT_SUCCESS;
+}
+
 //=======================================================
 //  INITIALIZATION
 //=======================================================
@@ -63,15 +291,90 @@ double myrand(void) { // generate uniform random number in [0,1)
          ((double)UINT32_MAX + 1.0);
 }
 
+//=======================================================
+//  LEVY FLIGHTS
+//=======================================================
+
+// Runs with Pareto jumps; same seeds as the unit-step runs, one draw per
+// jump (bit 0 = sign, bits 2..31 = length)
+static int run_levy(int runs, int iterations, double alpha) {
+  if (iterations < 1) {
+    fprintf(stderr, "levy: need at least 1 iteration per run\n");
+    return EXIT_FAILURE;
+  }
+  levy_table_t tab;
+  long *times = NULL;
+  int ntimes = levy_times(iterations, &times);
+  levy_stats_t *stats =
+      ntimes > 0 ? calloc((size_t)ntimes, sizeof(*stats)) : NULL;
+  if (levy_table_init(&tab, alpha) != 0) {
+    fprintf(stderr, "levy: need %g <= alpha <= 2\n", LEVY_ALPHA_MIN);
+    free(times);
+    free(stats);
+    return EXIT_FAILURE;
+  }
+  if (!stats) {
+    free(times);
+    return handle_mem_err();
+  }
+
+  uint32_t r[LEVY_BATCH];
+  int64_t len[LEVY_BATCH];
+  for (int run = 0; run < runs; ++run) {
+    unsigned int seed1 = generate_seed();
+    unsigned int seed2 = generate_seed();
+    myrand_init(seed1, seed2);
+
+    int64_t position = 0;
+    int next = 0; // next output time
+    for (int i = 0; i < iterations; i += LEVY_BATCH) {
+      int n = (iterations - i < LEVY_BATCH) ? iterations - i : LEVY_BATCH;
+      for (int k = 0; k < n; k++)
+        r[k] = pcg32_random_r(&pcg32_random_state);
+      levy_fill(&tab, r, len, n);
+      for (int k = 0; k < n; k++) {
+        position += (r[k] & 1) ? len[k] : -len[k];
+        if (i + k + 1 == times[next]) {
+          levy_stats_add(&stats[next], fabs((double)position));
+          next += (next + 1 < ntimes);
+        }
+      }
+    }
+    printf("Run %d complete (seeds: %u, %u)\n", run + 1, seed1, seed2);
+  }
+
+  int status = levy_write("../results/dat/levy_1d.dat", "1D, d = |x|",
+                          times, stats, ntimes, alpha);
+  if (status != 0)
+    perror("../results/dat/levy_1d.dat");
+  else
+    printf("Levy statistics written to '../results/dat/levy_1d.dat'\n");
+  free(times);
+  free(stats);
+  return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 //=======================================================
 //  MAIN FUNCTION
 //=======================================================
 int main(int argc, char **argv) {
-  if (argc != 3) {
+  static const char *const options[] = {"antithetic", "ctrw",  "alpha",
+                                        "tau0",       "levy",  "steps",
+                                        NULL};
+  const char *ctrw = opt_value(argc, argv, 3, "ctrw");
+  const char *steps = opt_value(argc, argv, 3, "steps");
+  if (argc < 3 || !opt_check(argc, argv, 3, options) ||
+      (ctrw && strcmp(ctrw, "exp") != 0 && strcmp(ctrw, "pareto") != 0) ||
+      ((ctrw != NULL) + (opt_value(argc, argv, 3, "levy") != NULL) +
+           (steps != NULL) + (opt_long(argc, argv, 3, "antithetic", 0) != 0) >
+       1)) {
     fprintf(stdout, ">>>> PROGRAM INSTRUCTIONS <<<<\n");
     fprintf(
         stderr,
-        "Compile with: %s <number of runs> <number of iterations per run'>\n",
+        "Compile with: %s <number of runs> <number of iterations per run'> "
+        "[antithetic=1]\n"
+        "       or [ctrw=exp|pareto] [alpha=0.5] [tau0=1] or [levy=alpha]\n"
+        "       or [steps=dx:w,dx:w,...]\n",
         argv[0]);
 
     return EXIT_FAILURE;
@@ -82,97 +385,165 @@ int main(int argc, char **argv) {
 
   runs = atof(argv[1]);       // total number of runs
   iterations = atof(argv[2]); // iterations for single run
+  int antithetic = opt_long(argc, argv, 3, "antithetic", 0) != 0;
+  double alpha = opt_double(argc, argv, 3, "alpha", 0.5);
+  double tau0 = opt_double(argc, argv, 3, "tau0", 1.0);
+  if (ctrw && (alpha < 0.1 || tau0 <= 0.0)) {
+    fprintf(stderr, "ctrw: need alpha >= 0.1 and tau0 > 0\n");
+    return EXIT_FAILURE;
+  }
+  if (opt_value(argc, argv, 3, "levy"))
+    return run_levy(runs, iterations, opt_double(argc, argv, 3, "levy", 1.0));
+  step_dist_t dist;
+  if (steps) {
+    if (step_dist_parse(&dist, 1, steps) != 0) {
+      fprintf(stderr, "steps: expected dx:w,dx:w,... (weights >= 0, "
+                      "|dx| <= %d)\n",
+              STEP_DIST_MAX_JUMP);
+      return EXIT_FAILURE;
+    }
+    if ((int64_t)iterations * step_dist_max_jump(&dist) > X_REACH) {
+      fprintf(stderr, "steps: iterations * max |dx| must not exceed %lld\n",
+              X_REACH);
+      return EXIT_FAILURE;
+    }
+    double v = step_dist_mean(&dist, 0);
+    printf("steps: drift %g, <x^2(t)> = %g t + %g t^2\n", v,
+           step_dist_msd(&dist) - v * v, v * v);
+  }
+
+  // exact ensemble sums of x^2 and x^4 at every time, accumulated while the
+  // walks run (integer sums: independent of the order runs are merged in)
+  exact_acc_t *x2_acc = calloc(iterations, sizeof(*x2_acc));
+  if (!x2_acc) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    return EXIT_FAILURE;
+  }
+
+  // trajectories are formatted and written by a dedicated writer thread;
+  // the walk only pushes binary records into its ring
+  rec_writer_t *writer = rw_create(1, RW_DEFAULT_RING);
+  if (!writer) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    free(x2_acc);
+    return EXIT_FAILURE;
+  }
+  int traj_sink = rw_add_sink(writer, "../results/dat/ran_gen.dat", "a",
+                              format_traj, NULL);
+  if (traj_sink < 0) {
+    perror("../results/dat/ran_gen.dat");
+    rw_finish(writer); // never started: just frees
+    free(x2_acc);
+    return EXIT_FAILURE;
+  }
+  if (rw_start(writer) != 0) {
+    fprintf(stderr, "Cannot start the writer thread.\n");
+    rw_finish(writer);
+    free(x2_acc);
+    return EXIT_FAILURE;
+  }
+  spsc_ring_t *ring = rw_producer_ring(writer, 0);
+
+  if (ctrw) {
+    zig_init();
+    pareto_init(alpha, tau0);
+    exp_tau0 = tau0;
+    int pareto = strcmp(ctrw, "pareto") == 0;
+    if (run_ctrw(runs, iterations, pareto, x2_acc, ring, traj_sink) !=
+        EXIT_SUCCESS) {
+      rw_finish(writer);
+      free(x2_acc);
+      return EXIT_FAILURE;
+    }
+  }
 
   double *A = NULL; // array of random generated values
-  for (int run = 0; run < runs; ++run) {
+  for (int run = 0; !ctrw && run < runs; ++run) { // unit-step runs
     unsigned int seed1 = generate_seed();
     unsigned int seed2 = generate_seed();
     myrand_init(seed1, seed2); // rand number generation
 
-    int position = 0, time = 0;                     // initial conditions
-    if (mtrx_alloc(&A, iterations) != EXIT_SUCCESS) // matrix allocation
-      return EXIT_FAILURE;
-
-    // open output file in append mode
-    FILE *fp = fopen("../results/dat/ran_gen.dat", "a");
-    if (!fp) {
-      perror("fopen");
-      free(A);
+    int64_t position = 0; // initial conditions
+    int64_t odd_sum = 0;  // sum of the odd steps (antithetic partner)
+    if (mtrx_alloc(&A, iterations) != EXIT_SUCCESS) { // matrix allocation
+      rw_finish(writer);
+      free(x2_acc);
       return EXIT_FAILURE;
     }
 
     for (int i = 0; i < iterations; i++) {
-      A[i] = myrand();
-      // random walk step
-      if (A[i] > 0.5)
-        position += 1;
-      else
-        position -= 1;
-
-      int pos_sqr = position * position; // x^2
-      fprintf(fp, "%d %d %d %d\n", i, position, pos_sqr, time);
-      time++;
+      int64_t prev = position;
+      if (steps) { // alias-table step
+        position += dist.dx[step_dist_sample(
+            &dist, pcg32_random_r(&pcg32_random_state))];
+      } else {
+        A[i] = myrand();
+        // random walk step
+        if (A[i] > 0.5)
+          position += 1;
+        else
+          position -= 1;
+      }
+
+      int64_t pos_sqr = position * position; // x^2
+      if (antithetic) {
+        // pair estimator (x^2 + x'^2) / 2 = E^2 + O^2, x' = E - O
+        odd_sum += (i & 1) ? position - prev : 0;
+        int64_t even_sum = position - odd_sum;
+        exact_acc_add(&x2_acc[i], even_sum * even_sum + odd_sum * odd_sum);
+      } else {
+        exact_acc_add(&x2_acc[i], pos_sqr);
+      }
+      rw_push(ring, traj_sink, i, position, 0); // "i x x^2 time" line
     }
-    // close file and free memory
-    fclose(fp);
+    // free memory
     free(A);
     printf("Run %d complete (seeds: %u, %u)\n", run + 1, seed1, seed2);
   }
 
-  // compute ensemble mean <x^2(t)>
-
-  // initialize accumulator array
-  double *sum = calloc(iterations, sizeof(double));
-  if (!sum) {
-    fprintf(stderr, "Memory allocation failed.\n");
+  if (rw_finish(writer) != 0) {
+    fprintf(stderr, "../results/dat/ran_gen.dat: write failed.\n");
+    free(x2_acc);
     return EXIT_FAILURE;
   }
 
-  // read all runs from data file
-  FILE *fp = fopen("../results/dat/ran_gen.dat", "r");
+  // write ensemble mean <x^2(t)> and its standard error to file
+  FILE *fp = fopen("../results/dat/x2_mean.dat", "w");
   if (!fp) {
     perror("fopen");
-    free(sum);
+    free(x2_acc);
     return EXIT_FAILURE;
   }
-  int dummy_i, dummy_pos, pos_sqr, dummy_time; // dummy variables
-  int status;                                  // used for flowing inside file
-  int run_idx = 0, t_idx = 0;                  // run index - time index
-  while ((status = fscanf(fp, "%d %d %d %d", &dummy_i, &dummy_pos, &pos_sqr,
-                          &dummy_time)) == 4) {
-    sum[t_idx] += pos_sqr;   // sum upgrading
-    t_idx++;                 // time increasing
-    if (t_idx == iterations) // go to next run
-    {
-      t_idx = 0;
-      run_idx++;
-      if (run_idx == runs)
-        break; // end file -> read completed
-    }
-  }
-  if (status != EOF && status != 4 &&
-      run_idx != runs) // reading file error check
-  {
-    perror("fscanf");
+  // lines "%d %f %f\n" (time & <x^2> & error), formatted into a large
+  // buffer and written in blocks
+  enum { OUT_BUF = 1 << 16, OUT_LINE = 1024 };
+  char *buf = malloc(OUT_BUF);
+  if (!buf) {
+    fprintf(stderr, "Memory allocation failed.\n");
     fclose(fp);
+    free(x2_acc);
     return EXIT_FAILURE;
   }
-  fclose(fp);
-
-  // write <x^2(t)> values to file
-  fp = fopen("../results/dat/x2_mean.dat", "w");
-  if (!fp) {
-    perror("fopen");
-    free(sum);
-    return EXIT_FAILURE;
-  }
+  size_t used = 0;
   for (int t = 0; t < iterations; t++) {
-    double avg = sum[t] / runs;
-    fprintf(fp, "%d %f\n", t, avg); // time & <x^2>
+    double avg = exact_acc_mean(&x2_acc[t]);
+    double err = exact_acc_err(&x2_acc[t]);
+    if (used + OUT_LINE > OUT_BUF) {
+      fwrite(buf, 1, used, fp);
+      used = 0;
+    }
+    used += fmt_i64(buf + used, t);
+    buf[used++] = ' ';
+    used += fmt_fixed(buf + used, avg, 6);
+    buf[used++] = ' ';
+    used += fmt_fixed(buf + used, err, 6);
+    buf[used++] = '\n';
   }
+  fwrite(buf, 1, used, fp);
+  free(buf);
 
   fclose(fp);
-  free(sum);
+  free(x2_acc);
 
   printf("Mean <x^2> written to '../results/dat/x2_mean.dat'\n");
 
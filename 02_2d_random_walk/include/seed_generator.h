@@ -67,6 +67,18 @@ void seedgen_init(uint64_t state, uint64_t seq);
  */
 unsigned int generate_seed(void);
 
+/**
+ * @brief Return seed number `index` of the stream started by seedgen_init()
+ * 
+ * @param index Zero-based position in the seed stream
+ * @return unsigned int The seed the (index+1)-th generate_seed() call after
+ *         seedgen_init() returns
+ * 
+ * Jumps ahead in O(log index) steps without touching the generate_seed()
+ * state, so threads can derive the seeds of any run independently.
+ */
+unsigned int generate_seed_at(uint64_t index);
+
 /**
  * @brief Test utility to print n generated seeds
  * 
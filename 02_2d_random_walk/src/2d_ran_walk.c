@@ -11,23 +11,179 @@
  * - Multiple independent simulation runs
  * - Configurable iterations per run
  * - Fixed-time sampling for statistical analysis
- * - Automatic mean and variance calculation
+ * - Automatic mean and variance calculation (exact integer moments)
  * - High-quality PCG32 random number generation
  *
  * Output: Data file containing run number, time, step number, and x-position
  *         at the specified target time for each run.
+ *
+ * Output lines are not formatted in the walk loop: records go through a
+ * lock-free ring to a writer thread (common/rec_writer) that does the
+ * formatting and the file I/O.
+ *
+ * Plot-ready products (read directly by make_plots.gp, so plotting time does
+ * not grow with the ensemble):
+ * - 2d_P_x1.dat:      binned, normalized P(x1) at the target time
+ * - 2d_P_x1x2.bin:    P(x1,x2) on a grid, gnuplot "binary matrix" (float32)
+ * - 2d_ran_walk_trace_dec.bin: decimated trace of the first run, int32
+ *                     triples (time, x, y), gnuplot "binary format"
+ *
+ * Runs are independent: run r is seeded with seeds 2r and 2r+1 of the seed
+ * stream (generate_seed_at), so with threads=n the runs are spread over n
+ * walker threads and the output is identical to the serial program. Each
+ * thread accumulates moments and histograms in its own slab
+ * (common/thread_acc), merged with exact integer sums.
+ *
+ * antithetic=g reuses each run's random stream for a mirrored partner walk:
+ * the D4 lattice symmetry g (rot90, rot180, rot270, mirror_x, mirror_y,
+ * diag, antidiag) is applied to every odd step. With E and O the sums of
+ * the even and odd steps, the pair is r = E + O and r' = E + g(O); both are
+ * exact walks, so moments and histograms take 2 * runs samples for the RNG
+ * cost of runs. Pairs are correlated, so the printed errors of <x>, <x^2>
+ * come from the per-pair means (r + r') / 2 rather than from single walks.
+ *
+ * tilt=s fills the tails of P(x1) by importance sampling: steps are drawn
+ * with probabilities e^s/Z, e^-s/Z, 1/Z, 1/Z (+x, -x, +y, -y; Z = e^s +
+ * e^-s + 2) and every walker carries the running log likelihood ratio
+ * log w = sum log(1/4 / q(step)). 2d_P_x1.dat then holds the weighted
+ * estimate P = sum w / (runs * bin) with the effective sample size
+ * (sum w)^2 / sum w^2 and log10 P of each bin; weights are summed in
+ * log-sum-exp form, so bins far below double range keep their value. The
+ * threads only store the log weight of every walk; the floating-point sums
+ * are formed afterwards in run order, so they too do not depend on the
+ * thread count. The walks concentrate around x1 = t * sinh(s) / (1 + cosh s)
+ * instead of 0. Only 2d_P_x1.dat is reweighted: the per-run lines show the
+ * tilted walks, MEAN/VAR are the unweighted moments of the tilted walks (not
+ * estimates for the unbiased walk), and 2d_P_x1x2.bin is not written.
+ *
+ * visits=1 also follows the set of visited sites of every walk (the
+ * primary walk under antithetic/tilt) and writes 2d_S_t.dat: the mean
+ * number of distinct sites S(t) and of returns to the origin at log-spaced
+ * times, with errors over runs. The visited set is a hash of 64 x 64-site
+ * bitmap tiles allocated on demand, so memory follows the visited region
+ * rather than the walk's bounding box; consecutive steps nearly always stay
+ * in the cached tile, and the per-step cost is O(1) amortized.
+ *
+ * torus=L switches to cover-time runs: the walk moves on the L x L torus
+ * with the neighbour tables of the lattice gas (common/torus.h) until every
+ * site has been visited, or for at most `iterations` steps. Per-run cover
+ * times go to 2d_cover.dat ("run cover_time", 0 = not covered); t_target
+ * is ignored.
+ *
+ * levy=alpha turns the walk into a lattice Levy flight: every step jumps
+ * an integer Pareto length L, P(L >= l) = l^-alpha, along one of the four
+ * axis directions (common/levy.h; one 32-bit draw per jump, drawn in
+ * batches). The runs then only write 2d_levy.dat, the mean of
+ * ln(1 + |r|) and quantiles of |r| at log-spaced times; t_target is
+ * ignored.
+ *
+ * steps=spec replaces the four unit steps by any finite step distribution
+ * ("king", "diag" or "dx:dy:w,..."; common/step_dist.h), drawn from an
+ * alias table with one 32-bit draw per step. The P(x1) bins and the
+ * P(x1,x2) grid follow the largest step and the step variance.
+ *
+ * env=L walks in a quenched random environment: site s of the L x L torus
+ * has its own hop probabilities p_s(+x, -x, +y, -y), weights
+ * 1 - d + 2 d u (u uniform, d = disorder in [0, 1]) drawn once from
+ * env_seed. A site is one 32-bit word of three cumulative 8-bit thresholds,
+ * generated before the threads start and read by all of them; a step is
+ * one load and three byte compares against 8 bits of the run's draw, so
+ * one draw serves four steps. The probabilities are quantized to 1/256
+ * (-y keeps at least 1/256). Positions stay unwrapped: the environment is
+ * periodic with period L and every walk starts at site (0, 0).
+ *
+ * Usage: echo "runs iterations t_target" | ./program_2d [bin=w]
+ *        [trace_points=n] [threads=n] [antithetic=g] [tilt=s] [visits=1]
+ *        [torus=L] [levy=alpha] [steps=spec] [env=L] [disorder=d]
+ *        [env_seed=n]
  */
 
+#include "../../common/include/cli_opts.h"
+#include "../../common/include/exact_acc.h"
+#include "../../common/include/levy.h"
+#include "../../common/include/fast_fmt.h"
+#include "../../common/include/rec_writer.h"
+#include "../../common/include/step_dist.h"
+#include "../../common/include/thread_acc.h"
+#include "../../common/include/torus.h"
 #include "../include/seed_generator.h"
+#include <math.h>
+#include <pthread.h>
+#include <sched.h> // for sched_yield()
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h> // for getpid()
 
 // Lattice step size (unit step in each direction)
 #define lattice_step 1
 
+// Plot-ready products
+#define TRACE_POINTS 20000   // default points kept in the decimated trace
+#define GRID_SIGMAS 5.0      // P(x1,x2) grid half-width in units of sqrt(t/2)
+#define GRID_MAX_CELLS 1024  // cells per axis of the P(x1,x2) grid
+
+#define RUN_CHUNK 16 // runs a walker thread claims at a time
+
+// Visited-site tracking
+#define TILE_SHIFT 6              // tiles of 64 x 64 sites
+#define VISIT_POINTS_PER_DECADE 20 // S(t) output times
+#define ENV_SEQ 0x656e76ULL       // PCG stream of the environment
+
+/**
+ * @brief D4 symmetries for antithetic partner walks
+ *
+ * m = {a, b, c, d} maps an odd-step displacement (ox, oy) to
+ * (a*ox + b*oy, c*ox + d*oy).
+ */
+static const struct {
+  const char *name;
+  int m[4];
+} mirrors[] = {
+    {"rot90", {0, -1, 1, 0}},    {"rot180", {-1, 0, 0, -1}},
+    {"rot270", {0, 1, -1, 0}},   {"mirror_x", {-1, 0, 0, 1}},
+    {"mirror_y", {1, 0, 0, -1}}, {"diag", {0, 1, 1, 0}},
+    {"antidiag", {0, -1, -1, 0}},
+};
+
+// Moment accumulators at t_target: all walks, and per antithetic pair the
+// sums x + x', x^2 + x'^2 (one sample per pair)
+enum { MOM_X, MOM_Y, MOM_PX, MOM_PY, MOM_PX2, MOM_PY2, MOM_COUNT };
+
+/**
+ * @struct lse_acc_t
+ * @brief Sums of importance weights w = exp(lw) in log-sum-exp form
+ *
+ * sum w = exp(m) * s1 and sum w^2 = exp(2m) * s2; s1 == 0 means empty (the
+ * all-zero state of calloc'd memory).
+ */
+typedef struct {
+  double m, s1, s2;
+} lse_acc_t;
+
+static inline void lse_add(lse_acc_t *a, double lw) {
+  if (a->s1 == 0.0) {
+    *a = (lse_acc_t){lw, 1.0, 1.0};
+  } else if (lw > a->m) {
+    double r = exp(a->m - lw);
+    a->s1 = a->s1 * r + 1.0;
+    a->s2 = a->s2 * r * r + 1.0;
+    a->m = lw;
+  } else {
+    double r = exp(lw - a->m);
+    a->s1 += r;
+    a->s2 += r * r;
+  }
+}
+
+// Effective sample size (sum w)^2 / sum w^2
+static double lse_ess(const lse_acc_t *a) {
+  return (a->s1 > 0.0) ? a->s1 * a->s1 / a->s2 : 0.0;
+}
+
 /*============================================================================
  * PCG32 RANDOM NUMBER GENERATOR
  *
@@ -110,6 +266,209 @@ double myrand(void) {
          ((double)UINT32_MAX + 1.0);
 }
 
+/**
+ * @brief Uniform double in [0,1) from a caller-owned generator
+ *
+ * Same conversion as myrand(); used by the walker threads, each of which
+ * owns the generator of the run it is simulating.
+ */
+static double myrand_r(pcg32_random_t *rng) {
+  return (double)pcg32_random_r(rng) / ((double)UINT32_MAX + 1.0);
+}
+
+/*============================================================================
+ * OUTPUT FORMATTING (runs on the writer thread)
+ *===========================================================================*/
+
+/**
+ * @brief Per-run line "run time step x y" from a record (run, x, y)
+ *
+ * @param ctx Pointer to the target time (time = t_target, step = time - 1)
+ *
+ * Same bytes as fprintf "%d %d %d %ld %ld\n", without the format parsing.
+ */
+static size_t format_run(char *out, const spsc_record_t *rec,
+                         const void *ctx) {
+  int t_target = *(const int *)ctx;
+  size_t n = fmt_i64(out, rec->v[0]);
+  out[n++] = ' ';
+  n += fmt_i64(out + n, t_target);
+  out[n++] = ' ';
+  n += fmt_i64(out + n, t_target - 1);
+  out[n++] = ' ';
+  n += fmt_i64(out + n, rec->v[1]);
+  out[n++] = ' ';
+  n += fmt_i64(out + n, rec->v[2]);
+  out[n++] = '\n';
+  return n;
+}
+
+/**
+ * @brief Trajectory line "time x y" ("%d %ld %ld\n") from a record
+ */
+static size_t format_trace(char *out, const spsc_record_t *rec,
+                           const void *ctx) {
+  (void)ctx;
+  size_t n = fmt_i64(out, rec->v[0]);
+  out[n++] = ' ';
+  n += fmt_i64(out + n, rec->v[1]);
+  out[n++] = ' ';
+  n += fmt_i64(out + n, rec->v[2]);
+  out[n++] = '\n';
+  return n;
+}
+
+/**
+ * @brief Decimated trace point: three native int32 (time, x, y)
+ *
+ * Read in gnuplot with binary format="%int32%int32%int32".
+ */
+static size_t format_trace_bin(char *out, const spsc_record_t *rec,
+                               const void *ctx) {
+  (void)ctx;
+  int32_t v[3] = {(int32_t)rec->v[0], (int32_t)rec->v[1], (int32_t)rec->v[2]};
+  memcpy(out, v, sizeof(v));
+  return sizeof(v);
+}
+
+/*============================================================================
+ * PLOT-READY HISTOGRAMS
+ *===========================================================================*/
+
+/**
+ * @struct hist2d_t
+ * @brief Position histograms at the target time
+ *
+ * P(x1) uses bins [k*w, (k+1)*w) labelled by their left edge, the same
+ * binning make_plots.gp used to do with bin_width()/smooth freq. P(x1,x2)
+ * is a square grid of cells of width gw covering +-GRID_SIGMAS standard
+ * deviations; the few samples outside it are counted in one extra element
+ * after the grid. The counts live in per-thread slabs (hist_attach).
+ */
+typedef struct {
+  long w, hx_lo, nhx;   // P(x1): bin width, first bin index, number of bins
+  int64_t *hx;          // P(x1) counts
+  long gw, g_lo, ng;    // grid: cell width, first cell index, cells per axis
+  int64_t *grid;        // ng x ng counts (row index = x2 cell), then the
+                        // number of samples outside the grid
+} hist2d_t;
+
+// floor(a / b) for b > 0 and any sign of a
+static long floor_div(long a, long b) { return a / b - (a % b < 0); }
+
+// Histogram geometry for |x1|, |x2| <= reach and a per-axis variance var;
+// the counts are attached with hist_attach()
+static void hist_init(hist2d_t *h, long reach, double var, long w) {
+  h->w = w;
+  h->hx_lo = floor_div(-reach, w);
+  h->nhx = floor_div(reach, w) - h->hx_lo + 1;
+
+  long half = (long)ceil(GRID_SIGMAS * sqrt(var));
+  if (half > reach)
+    half = reach;
+  h->gw = w;
+  if (2 * half / h->gw + 1 > GRID_MAX_CELLS)
+    h->gw = 2 * half / (GRID_MAX_CELLS - 1) + 1;
+  h->g_lo = floor_div(-half, h->gw);
+  h->ng = floor_div(half, h->gw) - h->g_lo + 1;
+  h->hx = h->grid = NULL;
+}
+
+// Count arrays of thread tid: slabs of nhx and ng*ng + 1 int64 counters
+static void hist_attach(hist2d_t *h, thread_acc_t *hx, thread_acc_t *grid,
+                        int tid) {
+  h->hx = tacc_slab(hx, tid);
+  h->grid = tacc_slab(grid, tid);
+}
+
+static long hist_clipped(const hist2d_t *h) { return h->grid[h->ng * h->ng]; }
+
+static inline void hist_add(hist2d_t *h, long x, long y) {
+  h->hx[floor_div(x, h->w) - h->hx_lo]++;
+  long i = floor_div(x, h->gw) - h->g_lo, j = floor_div(y, h->gw) - h->g_lo;
+  if (i >= 0 && i < h->ng && j >= 0 && j < h->ng)
+    h->grid[j * h->ng + i]++;
+  else
+    h->grid[h->ng * h->ng]++;
+}
+
+/**
+ * @brief Write "x1_bin P(x1)" for the non-empty bins, P = count/(runs*w)
+ */
+static int hist_write_px1(const hist2d_t *h, const char *path, int runs,
+                          int t_target) {
+  FILE *fp = fopen(path, "w");
+  if (!fp)
+    return -1;
+  fprintf(fp, "# P(x1) at t = %d, runs = %d, bin width = %ld\n", t_target,
+          runs, h->w);
+  fprintf(fp, "# x1_bin(left edge)  P(x1)\n");
+  double norm = 1.0 / ((double)runs * (double)h->w);
+  for (long k = 0; k < h->nhx; k++)
+    if (h->hx[k] > 0)
+      fprintf(fp, "%ld %.10e\n", (h->hx_lo + k) * h->w, h->hx[k] * norm);
+  return fclose(fp);
+}
+
+/**
+ * @brief Write "x1_bin P(x1) ESS log10_P" from importance weights
+ *
+ * P = sum w / (runs*w_bin), the likelihood-ratio estimate of the unbiased
+ * P(x1); log10_P stays finite where P underflows.
+ */
+static int hist_write_px1_weighted(const hist2d_t *h, const lse_acc_t *hw,
+                                   const char *path, int runs, int t_target,
+                                   double s) {
+  FILE *fp = fopen(path, "w");
+  if (!fp)
+    return -1;
+  fprintf(fp,
+          "# P(x1) at t = %d, runs = %d, bin width = %ld, tilt s = %g "
+          "(reweighted)\n",
+          t_target, runs, h->w, s);
+  fprintf(fp, "# x1_bin(left edge)  P(x1)  ESS  log10_P\n");
+  double lnorm = -log((double)runs * (double)h->w);
+  for (long k = 0; k < h->nhx; k++) {
+    if (hw[k].s1 == 0.0)
+      continue;
+    double lp = hw[k].m + log(hw[k].s1) + lnorm;
+    fprintf(fp, "%ld %.10e %.1f %.6f\n", (h->hx_lo + k) * h->w, exp(lp),
+            lse_ess(&hw[k]), lp / M_LN10);
+  }
+  return fclose(fp);
+}
+
+/**
+ * @brief Write P(x1,x2) = count/(runs*gw^2) as a gnuplot binary matrix
+ *
+ * Layout (float32): first row = ng followed by the x1 cell centres, then for
+ * every x2 cell its centre followed by the ng values of that row.
+ */
+static int hist_write_grid(const hist2d_t *h, const char *path, int runs) {
+  FILE *fp = fopen(path, "wb");
+  if (!fp)
+    return -1;
+  float *row = malloc((size_t)(h->ng + 1) * sizeof(*row));
+  if (!row) {
+    fclose(fp);
+    return -1;
+  }
+  double norm = 1.0 / ((double)runs * (double)h->gw * (double)h->gw);
+  row[0] = (float)h->ng;
+  for (long i = 0; i < h->ng; i++)
+    row[i + 1] = (float)((h->g_lo + i) * h->gw + 0.5 * (h->gw - 1));
+  fwrite(row, sizeof(*row), (size_t)h->ng + 1, fp);
+  for (long j = 0; j < h->ng; j++) {
+    row[0] = (float)((h->g_lo + j) * h->gw + 0.5 * (h->gw - 1));
+    for (long i = 0; i < h->ng; i++)
+      row[i + 1] = (float)(h->grid[j * h->ng + i] * norm);
+    fwrite(row, sizeof(*row), (size_t)h->ng + 1, fp);
+  }
+  free(row);
+  return fclose(fp);
+}
+
+
 /*============================================================================
  * STATISTICAL FUNCTIONS
  *===========================================================================*/
@@ -154,11 +513,685 @@ double var_funct(size_t dim, double **arr, double (*avg)(size_t, double **)) {
   return sqrdev / (dim - 1);
 }
 
+/*============================================================================
+ * VISITED SITES
+ *===========================================================================*/
+
+/**
+ * @struct tile_t
+ * @brief 64 x 64 sites, one bit each: row[y & 63] bit (x & 63)
+ */
+typedef struct {
+  uint64_t key; // tile coordinates (x >> 6, y >> 6) packed in 32+32 bits
+  uint64_t row[1 << TILE_SHIFT];
+} tile_t;
+
+/**
+ * @struct visit_set_t
+ * @brief Sparse set of visited sites: open-addressing hash of tiles
+ *
+ * Tiles come from a pool that only grows, so a thread reuses the memory of
+ * its previous runs; slot[] holds pool index + 1 (0 = empty) and is kept at
+ * most half full. The tile of the last lookup is cached.
+ */
+typedef struct {
+  tile_t *pool;
+  size_t ntiles, cap;  // tiles in use / allocated
+  uint32_t *slot;
+  size_t mask;         // slot table size - 1 (power of two)
+  uint64_t last_key;
+  tile_t *last;
+} visit_set_t;
+
+static inline uint64_t tile_key(long x, long y) {
+  // arithmetic shifts: floor division by 64 for negative coordinates too
+  return ((uint64_t)(uint32_t)(x >> TILE_SHIFT) << 32) |
+         (uint32_t)(y >> TILE_SHIFT);
+}
+
+static inline size_t tile_hash(uint64_t key, size_t mask) {
+  return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+static int vs_init(visit_set_t *v) {
+  memset(v, 0, sizeof(*v));
+  v->mask = 63;
+  v->slot = calloc(v->mask + 1, sizeof(*v->slot));
+  return v->slot ? 0 : -1;
+}
+
+static void vs_free(visit_set_t *v) {
+  free(v->pool);
+  free(v->slot);
+}
+
+// Empty the set; cost proportional to the previous run's tiles
+static void vs_clear(visit_set_t *v) {
+  memset(v->slot, 0, (v->mask + 1) * sizeof(*v->slot));
+  v->ntiles = 0;
+  v->last = NULL;
+}
+
+// Double the slot table and reinsert every tile
+static int vs_grow(visit_set_t *v) {
+  size_t mask = 2 * v->mask + 1;
+  uint32_t *slot = calloc(mask + 1, sizeof(*slot));
+  if (!slot)
+    return -1;
+  for (size_t i = 0; i < v->ntiles; i++) {
+    size_t h = tile_hash(v->pool[i].key, mask);
+    while (slot[h])
+      h = (h + 1) & mask;
+    slot[h] = (uint32_t)(i + 1);
+  }
+  free(v->slot);
+  v->slot = slot;
+  v->mask = mask;
+  return 0;
+}
+
+// Tile holding key, allocated (zeroed) on first use; NULL if out of memory
+static tile_t *vs_tile(visit_set_t *v, uint64_t key) {
+  size_t h = tile_hash(key, v->mask);
+  for (; v->slot[h]; h = (h + 1) & v->mask)
+    if (v->pool[v->slot[h] - 1].key == key)
+      return &v->pool[v->slot[h] - 1];
+
+  // make room first, so a failure leaves the set unchanged
+  if (2 * (v->ntiles + 1) > v->mask + 1) { // keep the load <= 1/2
+    if (vs_grow(v) != 0)
+      return NULL;
+    for (h = tile_hash(key, v->mask); v->slot[h]; h = (h + 1) & v->mask)
+      ;
+  }
+  if (v->ntiles == v->cap) {
+    size_t cap = v->cap ? 2 * v->cap : 16;
+    tile_t *pool = realloc(v->pool, cap * sizeof(*pool));
+    if (!pool)
+      return NULL;
+    v->pool = pool;
+    v->cap = cap;
+    v->last = NULL; // pool moved
+  }
+  tile_t *t = &v->pool[v->ntiles++];
+  memset(t, 0, sizeof(*t));
+  t->key = key;
+  v->slot[h] = (uint32_t)v->ntiles;
+  return t;
+}
+
+/**
+ * @brief Mark (x, y) visited
+ *
+ * @return 1 if the site is new, 0 if already visited, -1 out of memory
+ */
+static inline int vs_visit(visit_set_t *v, long x, long y) {
+  uint64_t key = tile_key(x, y);
+  if (!v->last || key != v->last_key) {
+    if (!(v->last = vs_tile(v, key)))
+      return -1;
+    v->last_key = key;
+  }
+  uint64_t *row = &v->last->row[y & ((1 << TILE_SHIFT) - 1)];
+  uint64_t bit = 1ULL << (x & ((1 << TILE_SHIFT) - 1));
+  if (*row & bit)
+    return 0;
+  *row |= bit;
+  return 1;
+}
+
+/*============================================================================
+ * WALKER THREADS
+ *===========================================================================*/
+
+/**
+ * @struct strc
+ * @brief Structure to represent a lattice point and walk state
+ *
+ * @var x X-coordinate on the lattice
+ * @var y Y-coordinate on the lattice
+ * @var step Current step number in the walk
+ * @var time Current time (equivalent to step in this simulation)
+ */
+typedef struct p {
+  long int x, y;  // Position coordinates on 2D lattice
+  int step, time; // Step counter and time variable
+} strc;
+
+/**
+ * @struct ensemble_t
+ * @brief Work and accumulators shared by the walker threads
+ *
+ * Threads claim RUN_CHUNK runs at a time; which thread runs which run does
+ * not affect the results (per-run seeds, integer sums, per-run positions
+ * stored by run index).
+ */
+typedef struct {
+  int runs, iterations, t_target, trace_stride;
+  atomic_int next_run;   // first run of the next unclaimed chunk
+  const int *mirror;     // antithetic symmetry matrix, NULL if off
+  int walks;             // walks per run (2 with a partner walk)
+  long *pos_x, *pos_y;   // walk k of run r at t_target: [r * walks + k]
+  thread_acc_t moments;  // exact_acc_t[MOM_COUNT] at t_target, per thread
+  int tilted;            // importance sampling with tilt=s
+  uint64_t thr[3];       // tilted step: u < thr[0] +x, < thr[1] -x, ...
+  double lw_step[4];     // log(1/4 / q) of the tilted steps +x, -x, +y, -y
+  double *lw;            // tilt=s: log weight of walk k of run r, as pos_x
+  thread_acc_t hx, grid; // histogram counts per thread (see hist2d_t)
+  hist2d_t geom;         // histogram geometry
+  int visits;            // track S(t) and returns to the origin
+  long *vis_t;           // output times of S(t) (ascending), nvis of them
+  int nvis;
+  thread_acc_t vis;      // exact_acc_t: S at vis_t[i], then returns
+  torus_t torus;         // cover-time runs if torus.L > 0
+  long *cover;           // cover time of every run (0 = not covered)
+  // Levy flight jump lengths, NULL if off
+  const levy_table_t *levy;
+  long *levy_t;          // output times of the Levy statistics, nlevy
+  int nlevy;
+  thread_acc_t lstats;   // levy_stats_t at levy_t[i], per thread
+  // steps=spec alias table, NULL if off
+  const step_dist_t *steps;
+  // env=L: packed thresholds of site x * env_L + y, shared read-only
+  const uint32_t *env;
+  long env_L;
+  atomic_int failed;     // a thread ran out of memory
+  atomic_int gate;       // 0 while starting, then 1 (run) or -1 (abort)
+  rec_writer_t *writer;
+  int trace_sink, dec_sink;
+} ensemble_t;
+
+typedef struct {
+  ensemble_t *ens;
+  int tid;
+} walker_arg_t;
+
+/**
+ * @brief Simulate run `run` on its own generator
+ *
+ * Run r is seeded with seeds 2r and 2r+1 of the seed stream, exactly the
+ * seeds the serial loop drew with two generate_seed() calls per run. With
+ * e->mirror set the run also yields the partner walk E + g(O).
+ */
+static void walk_run(ensemble_t *e, int run, exact_acc_t *mom, hist2d_t *hist,
+                     visit_set_t *vs, exact_acc_t *vis, spsc_ring_t *ring) {
+  pcg32_random_t rng;
+  pcg32_srandom_r(&rng, generate_seed_at(2 * (uint64_t)run),
+                  generate_seed_at(2 * (uint64_t)run + 1));
+
+  // Initialize position at origin
+  strc pos = {0, 0, 0, 0};
+  long odd_x = 0, odd_y = 0; // sum of the odd steps (antithetic partner)
+  double lw = 0.0;           // log likelihood ratio of the tilted walk
+  int trace = (run == 0); // record the full trajectory of the first run
+  long sx = 0, sy = 0;    // env=L: site of the walker on the torus
+  uint32_t env_bits = 0;  // env=L: unused bytes of the last draw
+  long distinct = 0, returns = 0; // visits=1: S(t), returns to the origin
+  int next_vis = 0;
+  if (vs) {
+    vs_clear(vs);
+    distinct = vs_visit(vs, 0, 0);
+  }
+
+  /*====================================================================
+   * RANDOM WALK LOOP - Execute single random walk trajectory
+   *====================================================================*/
+  for (pos.step = 0; pos.step < e->iterations; pos.step++) {
+    long dx = 0, dy = 0;
+    if (e->steps) { // alias-table step
+      int d = step_dist_sample(e->steps, pcg32_random_r(&rng));
+      dx = e->steps->dx[d];
+      dy = e->steps->dy[d];
+    } else if (e->env) { // one threshold word, one byte of the draw
+      static const int8_t edx[4] = {1, -1, 0, 0}, edy[4] = {0, 0, 1, -1};
+      if ((pos.step & 3) == 0)
+        env_bits = pcg32_random_r(&rng);
+      uint32_t t = e->env[sx * e->env_L + sy], b = env_bits & 0xff;
+      env_bits >>= 8;
+      int d = (b >= (t & 0xff)) + (b >= ((t >> 8) & 0xff)) + (b >= (t >> 16));
+      dx = edx[d];
+      dy = edy[d];
+      sx += dx;
+      sy += dy;
+      sx += (sx < 0) ? e->env_L : (sx == e->env_L) ? -e->env_L : 0;
+      sy += (sy < 0) ? e->env_L : (sy == e->env_L) ? -e->env_L : 0;
+    } else if (e->tilted) {
+      // tilted direction from the integer thresholds, weight updated
+      static const int8_t tdx[4] = {1, -1, 0, 0}, tdy[4] = {0, 0, 1, -1};
+      uint32_t u = pcg32_random_r(&rng);
+      int d = (u >= e->thr[0]) + (u >= e->thr[1]) + (u >= e->thr[2]);
+      dx = tdx[d] * lattice_step;
+      dy = tdy[d] * lattice_step;
+      lw += e->lw_step[d];
+    } else {
+      // Generate random number in [0, 1) to determine step direction
+      long double r = myrand_r(&rng);
+
+      // Select direction based on random number (4 equally likely directions)
+      // [0, 0.25): move right  (+x direction)
+      // [0.25, 0.5): move left  (-x direction)
+      // [0.5, 0.75): move up    (+y direction)
+      // [0.75, 1): move down    (-y direction)
+      if (r < 0.25)
+        dx = lattice_step;
+      else if (r < 0.5)
+        dx = -lattice_step;
+      else if (r < 0.75)
+        dy = lattice_step;
+      else
+        dy = -lattice_step;
+    }
+    pos.x += dx;
+    pos.y += dy;
+    if (pos.step & 1) {
+      odd_x += dx;
+      odd_y += dy;
+    }
+
+    // Increment time counter (so we can check equality properly since it
+    // starts at 0)
+    pos.time++;
+
+    if (vs) {
+      int fresh = vs_visit(vs, pos.x, pos.y);
+      if (fresh < 0) {
+        atomic_store(&e->failed, 1);
+        vs = NULL; // stop tracking, reported by main()
+      } else {
+        distinct += fresh;
+        returns += (pos.x == 0 && pos.y == 0);
+        if (next_vis < e->nvis && pos.time == e->vis_t[next_vis]) {
+          exact_acc_add(&vis[next_vis], distinct);
+          exact_acc_add(&vis[e->nvis + next_vis], returns);
+          next_vis++;
+        }
+      }
+    }
+
+    // Record position data when target time is reached
+    // This allows statistical analysis of position distribution at fixed time
+    if (pos.time == e->t_target) {
+      long wx[2] = {pos.x, 0}, wy[2] = {pos.y, 0};
+      if (e->mirror) { // partner E + g(O) = r - O + g(O)
+        const int *m = e->mirror;
+        wx[1] = pos.x - odd_x + m[0] * odd_x + m[1] * odd_y;
+        wy[1] = pos.y - odd_y + m[2] * odd_x + m[3] * odd_y;
+        exact_acc_add(&mom[MOM_PX], wx[0] + wx[1]);
+        exact_acc_add(&mom[MOM_PY], wy[0] + wy[1]);
+        exact_acc_add(&mom[MOM_PX2], wx[0] * wx[0] + wx[1] * wx[1]);
+        exact_acc_add(&mom[MOM_PY2], wy[0] * wy[0] + wy[1] * wy[1]);
+      }
+      for (int k = 0; k < e->walks; k++) {
+        exact_acc_add(&mom[MOM_X], wx[k]); // Accumulate x-position moments
+        exact_acc_add(&mom[MOM_Y], wy[k]); // Accumulate y-position moments
+        hist_add(hist, wx[k], wy[k]);      // P(x1) and P(x1,x2) counts
+        if (e->tilted) // summed in run order after the threads
+          e->lw[(size_t)run * e->walks + k] = lw;
+        // per-run line, written in run order
+        e->pos_x[(size_t)run * e->walks + k] = wx[k];
+        e->pos_y[(size_t)run * e->walks + k] = wy[k];
+      }
+    }
+
+    // Record all steps of the traced run
+    if (trace) {
+      rw_push(ring, e->trace_sink, pos.time, pos.x, pos.y);
+      if (pos.time % e->trace_stride == 0 || pos.time == e->iterations)
+        rw_push(ring, e->dec_sink, pos.time, pos.x, pos.y);
+    }
+  }
+}
+
+/**
+ * @brief Quenched environment of L^2 sites: thresholds t0 <= t1 <= t2
+ *
+ * Byte k of site s holds 256 times the cumulative probability of the first
+ * k + 1 directions (+x, -x, +y), so a byte b of the draw selects
+ * direction (b >= t0) + (b >= t1) + (b >= t2).
+ *
+ * @return the malloc'ed table, NULL if out of memory
+ */
+static uint32_t *env_build(long L, double disorder, uint64_t seed) {
+  uint32_t *env = malloc((size_t)(L * L) * sizeof(*env));
+  if (!env)
+    return NULL;
+  pcg32_random_t rng;
+  pcg32_srandom_r(&rng, seed, ENV_SEQ);
+  for (long s = 0; s < L * L; s++) {
+    double w[4], sum = 0.0, cum = 0.0;
+    for (int k = 0; k < 4; k++)
+      sum += w[k] = 1.0 - disorder + 2.0 * disorder * myrand_r(&rng);
+    uint32_t word = 0;
+    for (int k = 0; k < 3; k++) {
+      cum += w[k] / sum;
+      long t = lround(256.0 * cum);
+      word |= (uint32_t)(t > 255 ? 255 : t) << (8 * k);
+    }
+    env[s] = word;
+  }
+  return env;
+}
+
+/**
+ * @brief Cover-time run on the torus: steps until all L^2 sites are seen
+ *
+ * Same seeds and step rule as walk_run(); the dense L^2-bit map `seen` is
+ * the thread's own.
+ */
+static void cover_run(ensemble_t *e, int run, uint64_t *seen) {
+  pcg32_random_t rng;
+  pcg32_srandom_r(&rng, generate_seed_at(2 * (uint64_t)run),
+                  generate_seed_at(2 * (uint64_t)run + 1));
+  const long L = e->torus.L, sites = L * L;
+  const long *plus = e->torus.plus, *minus = e->torus.minus;
+  memset(seen, 0, (size_t)((sites + 63) / 64) * sizeof(*seen));
+
+  long x = 0, y = 0, left = sites - 1;
+  seen[0] = 1;
+  e->cover[run] = 0;
+  for (long t = 1; t <= e->iterations; t++) {
+    long double r = myrand_r(&rng);
+    if (r < 0.25)
+      x = plus[x];
+    else if (r < 0.5)
+      x = minus[x];
+    else if (r < 0.75)
+      y = plus[y];
+    else
+      y = minus[y];
+    long site = x * L + y;
+    uint64_t bit = 1ULL << (site & 63);
+    if (!(seen[site >> 6] & bit)) {
+      seen[site >> 6] |= bit;
+      if (--left == 0) {
+        e->cover[run] = t;
+        return;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Levy flight run: Pareto jump lengths along the four axes
+ *
+ * Same seeds as walk_run(); each draw gives the direction (bits 0-1) and
+ * the length (bits 2-31).
+ */
+static void levy_run(ensemble_t *e, int run, levy_stats_t *stats) {
+  pcg32_random_t rng;
+  pcg32_srandom_r(&rng, generate_seed_at(2 * (uint64_t)run),
+                  generate_seed_at(2 * (uint64_t)run + 1));
+  uint32_t r[LEVY_BATCH];
+  int64_t len[LEVY_BATCH];
+  int64_t x = 0, y = 0;
+  int next = 0; // next output time
+  for (int i = 0; i < e->iterations; i += LEVY_BATCH) {
+    int n = (e->iterations - i < LEVY_BATCH) ? e->iterations - i : LEVY_BATCH;
+    for (int k = 0; k < n; k++)
+      r[k] = pcg32_random_r(&rng);
+    levy_fill(e->levy, r, len, n);
+    for (int k = 0; k < n; k++) {
+      int64_t l = (r[k] & 1) ? -len[k] : len[k];
+      if (r[k] & 2)
+        y += l;
+      else
+        x += l;
+      if (i + k + 1 == e->levy_t[next]) {
+        levy_stats_add(&stats[next], hypot((double)x, (double)y));
+        next += (next + 1 < e->nlevy);
+      }
+    }
+  }
+}
+
+static void *walker_thread(void *arg) {
+  ensemble_t *e = ((walker_arg_t *)arg)->ens;
+  int tid = ((walker_arg_t *)arg)->tid;
+
+  // the reduction barrier counts every thread: start only once all exist
+  int gate;
+  while ((gate = atomic_load(&e->gate)) == 0)
+    sched_yield();
+  if (gate < 0)
+    return NULL;
+
+  // zero this thread's slabs from this thread (first touch)
+  tacc_touch(&e->moments, tid);
+  tacc_touch(&e->hx, tid);
+  tacc_touch(&e->grid, tid);
+  exact_acc_t *mom = tacc_slab(&e->moments, tid);
+  hist2d_t hist = e->geom;
+  hist_attach(&hist, &e->hx, &e->grid, tid);
+  spsc_ring_t *ring = e->writer ? rw_producer_ring(e->writer, tid) : NULL;
+  tacc_touch(&e->vis, tid);
+  exact_acc_t *vis = tacc_slab(&e->vis, tid);
+  tacc_touch(&e->lstats, tid);
+  levy_stats_t *lstats = tacc_slab(&e->lstats, tid);
+  visit_set_t vset, *vs = NULL;
+  if (e->visits) {
+    if (vs_init(&vset) == 0)
+      vs = &vset;
+    else
+      atomic_store(&e->failed, 1);
+  }
+  uint64_t *seen = NULL;
+  if (e->torus.L > 0) {
+    long sites = e->torus.L * e->torus.L;
+    if (!(seen = malloc((size_t)((sites + 63) / 64) * sizeof(*seen))))
+      atomic_store(&e->failed, 1);
+  }
+
+  for (;;) {
+    int first = atomic_fetch_add(&e->next_run, RUN_CHUNK);
+    if (first >= e->runs)
+      break;
+    int last = (first + RUN_CHUNK < e->runs) ? first + RUN_CHUNK : e->runs;
+    for (int run = first; run < last; run++) {
+      if (e->torus.L > 0) {
+        if (seen)
+          cover_run(e, run, seen);
+      } else if (e->levy) {
+        levy_run(e, run, lstats);
+      } else {
+        walk_run(e, run, mom, &hist, vs, vis, ring);
+      }
+    }
+  }
+  if (e->writer)
+    rw_producer_done(e->writer, tid);
+  if (vs)
+    vs_free(vs);
+  free(seen);
+
+  // deterministic merge into slab 0 (integer sums)
+  tacc_reduce(&e->moments, tid, tacc_merge_exact_acc);
+  tacc_reduce(&e->hx, tid, tacc_merge_i64);
+  tacc_reduce(&e->grid, tid, tacc_merge_i64);
+  tacc_reduce(&e->vis, tid, tacc_merge_exact_acc);
+  tacc_reduce(&e->lstats, tid, levy_stats_merge);
+  return NULL;
+}
+
+/**
+ * @brief Write "t <S> err <R> err pi*t/ln(8t)" from the merged slab 0
+ *
+ * <R> is the mean number of returns to the origin up to t; the last column
+ * is the leading large-t behaviour of S(t) on the square lattice.
+ */
+static int write_visits(const ensemble_t *e, const char *path) {
+  const exact_acc_t *vis = tacc_slab(&e->vis, 0);
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return -1;
+  fprintf(f, "# t <S(t)> err <returns to origin> err pi*t/ln(8t)\n");
+  for (int i = 0; i < e->nvis; i++) {
+    const exact_acc_t *s = &vis[i], *r = &vis[e->nvis + i];
+    if (s->n == 0)
+      continue;
+    double t = (double)e->vis_t[i];
+    fprintf(f, "%ld %.6f %.6f %.6f %.6f %.6f\n", e->vis_t[i],
+            exact_acc_mean(s), exact_acc_err(s), exact_acc_mean(r),
+            exact_acc_err(r), M_PI * t / log(8.0 * t));
+  }
+  return fclose(f) == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Run all runs on nthreads walker threads and wait for them
+ *
+ * The walkers wait at e->gate until every thread exists; if one cannot be
+ * created the gate tells the others to return before tacc_reduce(), whose
+ * barrier would otherwise wait for the missing thread forever.
+ */
+static int run_walkers(ensemble_t *e, int nthreads) {
+  pthread_t *tids = malloc((size_t)nthreads * sizeof(*tids));
+  walker_arg_t *args = malloc((size_t)nthreads * sizeof(*args));
+  if (!tids || !args) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    free(tids);
+    free(args);
+    return -1;
+  }
+  int started = 0, status = 0;
+  atomic_store(&e->gate, 0);
+  for (; started < nthreads; started++) {
+    args[started] = (walker_arg_t){e, started};
+    if (pthread_create(&tids[started], NULL, walker_thread, &args[started]) !=
+        0) {
+      fprintf(stderr, "Cannot create walker thread %d.\n", started);
+      status = -1;
+      break;
+    }
+  }
+  atomic_store(&e->gate, status == 0 ? 1 : -1);
+  for (int t = 0; t < started; t++)
+    pthread_join(tids[t], NULL);
+  free(tids);
+  free(args);
+  return status;
+}
+
+/**
+ * @brief Release everything main() and cover_main() allocated in the ensemble
+ */
+static void ens_free(ensemble_t *e) {
+  tacc_free(&e->moments);
+  tacc_free(&e->hx);
+  tacc_free(&e->grid);
+  tacc_free(&e->vis);
+  tacc_free(&e->lstats);
+  free(e->vis_t);
+  free(e->levy_t);
+  free(e->pos_x);
+  free(e->pos_y);
+  free(e->lw);
+  free(e->cover);
+  torus_free(&e->torus);
+  e->vis_t = e->levy_t = e->pos_x = e->pos_y = e->cover = NULL;
+  e->lw = NULL;
+}
+
+/**
+ * @brief torus=L: cover times of all runs on the walker threads
+ *
+ * No writer thread: the per-run positions and traces of the free walk do
+ * not apply. Writes 2d_cover.dat and the mean against the asymptotic
+ * (4/pi) L^2 (ln L)^2. The caller releases the ensemble (ens_free).
+ */
+static int cover_main(ensemble_t *e, long L, int nthreads) {
+  e->cover = calloc((size_t)e->runs, sizeof(*e->cover));
+  if (!e->cover || torus_init(&e->torus, L) != 0) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    return EXIT_FAILURE;
+  }
+  if (run_walkers(e, nthreads) != 0)
+    return EXIT_FAILURE;
+  if (atomic_load(&e->failed)) {
+    fprintf(stderr, "Memory allocation failed (cover map).\n");
+    return EXIT_FAILURE;
+  }
+
+  FILE *f = fopen("../results/dat/2d_cover.dat", "w");
+  if (!f) {
+    perror("../results/dat/2d_cover.dat");
+    return EXIT_FAILURE;
+  }
+  exact_acc_t acc = {0};
+  fprintf(f, "# L = %ld: run cover_time (0 = not covered in %d steps)\n", L,
+          e->iterations);
+  for (int run = 0; run < e->runs; run++) {
+    fprintf(f, "%d %ld\n", run, e->cover[run]);
+    if (e->cover[run] > 0)
+      exact_acc_add(&acc, e->cover[run]);
+  }
+  if (fclose(f) != 0) {
+    perror("../results/dat/2d_cover.dat");
+    return EXIT_FAILURE;
+  }
+  double lnL = log((double)L);
+  printf("cover time L = %ld: %g +- %g (%ld of %d runs covered), "
+         "(4/pi) L^2 (ln L)^2 = %g\n",
+         L, exact_acc_mean(&acc), exact_acc_err(&acc), (long)acc.n, e->runs,
+         4.0 / M_PI * (double)(L * L) * lnL * lnL);
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief levy=alpha: Levy flights on the walker threads, 2d_levy.dat
+ *
+ * The caller releases the ensemble (ens_free).
+ */
+static int levy_main(ensemble_t *e, int nthreads) {
+  if (run_walkers(e, nthreads) != 0)
+    return EXIT_FAILURE;
+  if (levy_write("../results/dat/2d_levy.dat", "2D, d = |r|", e->levy_t,
+                 tacc_slab(&e->lstats, 0), e->nlevy, e->levy->alpha) != 0) {
+    perror("../results/dat/2d_levy.dat");
+    return EXIT_FAILURE;
+  }
+  printf("Levy flights (alpha = %g): %d runs of %d jumps, statistics in "
+         "'../results/dat/2d_levy.dat'\n",
+         e->levy->alpha, e->runs, e->iterations);
+  return EXIT_SUCCESS;
+}
+
 /*============================================================================
  * MAIN SIMULATION
  *===========================================================================*/
 
-int main() {
+int main(int argc, char **argv) {
+  static const char *const options[] = {"bin", "trace_points", "threads",
+                                        "antithetic", "tilt",   "visits",
+                                        "torus",      "levy",   "steps",
+                                        "env",        "disorder",
+                                        "env_seed",   NULL};
+  const char *anti = opt_value(argc, argv, 1, "antithetic");
+  const int *mirror = NULL;
+  for (size_t i = 0; anti && i < sizeof(mirrors) / sizeof(*mirrors); i++)
+    if (strcmp(anti, mirrors[i].name) == 0)
+      mirror = mirrors[i].m;
+  const char *tilt = opt_value(argc, argv, 1, "tilt");
+  const char *levy = opt_value(argc, argv, 1, "levy");
+  const char *steps = opt_value(argc, argv, 1, "steps");
+  long env_L = opt_long(argc, argv, 1, "env", 0);
+  double disorder = opt_double(argc, argv, 1, "disorder", 0.5);
+  if (!opt_check(argc, argv, 1, options) || (anti && !mirror) ||
+      (anti && tilt) || env_L < 0 || !(disorder >= 0.0 && disorder <= 1.0) ||
+      (env_L > 0 && (anti || tilt || levy || steps ||
+                     opt_value(argc, argv, 1, "torus"))) ||
+      (steps && (anti || tilt || levy || opt_value(argc, argv, 1, "torus"))) ||
+      (levy && (anti || tilt || opt_value(argc, argv, 1, "visits") ||
+                opt_value(argc, argv, 1, "torus")))) {
+    fprintf(stderr, "Usage: echo \"runs iterations t_target\" | %s [bin=w] "
+                    "[trace_points=n] [threads=n]\n"
+                    "       [antithetic=rot90|rot180|rot270|mirror_x|mirror_y|"
+                    "diag|antidiag] or [tilt=s] [visits=1] [torus=L]\n"
+                    "       or [levy=alpha] or [steps=king|diag|dx:dy:w,...]\n"
+                    "       or [env=L] [disorder=0.5] [env_seed=1]\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+
   // Initialize the seed generator (produces seeds for individual runs)
   // Uses fixed values for reproducibility - change for different sequences
   seedgen_init(12345ULL, 67890ULL);
@@ -189,139 +1222,297 @@ int main() {
     return EXIT_FAILURE;
   }
 
-  /**
-   * @struct strc
-   * @brief Structure to represent a lattice point and walk state
-   *
-   * @var x X-coordinate on the lattice
-   * @var y Y-coordinate on the lattice
-   * @var step Current step number in the walk
-   * @var time Current time (equivalent to step in this simulation)
-   */
-  typedef struct p {
-    long int x, y;  // Position coordinates on 2D lattice
-    int step, time; // Step counter and time variable
-  } strc;
-
-  // Initialize position at origin
-  strc pos = {0, 0, 0, 0};
+  // P(x1) bin width (default ~ sigma/3) and decimation of the first trace
+  long bin_w = opt_long(argc, argv, 1, "bin",
+                        lround(0.25 * sqrt((double)t_target)));
+  long trace_points = opt_long(argc, argv, 1, "trace_points", TRACE_POINTS);
+  if (bin_w < 1)
+    bin_w = 1;
+  if (trace_points < 1)
+    trace_points = 1;
+  int trace_stride = (int)((iterations + trace_points - 1) / trace_points);
 
-  // Accumulator for computing mean of x,y-positions at target time
-  double sum_vals_x = 0.0, sum_vals_y = 0.0;
+  int nthreads = (int)opt_long(argc, argv, 1, "threads", 1);
+  if (nthreads < 1)
+    nthreads = 1;
 
-  /*========================================================================
-   * MAIN SIMULATION LOOP - Execute multiple independent random walks
-   *========================================================================*/
-  for (int run = 0; run < runs; ++run) {
-    // Open output file in append mode (accumulates data from all runs)
-    FILE *fp = fopen("../results/dat/2d_ran_gen_t_100000.dat", "a");
-    if (!fp) {
-      perror("fopen");
+  ensemble_t ens = {.runs = runs,
+                    .iterations = iterations,
+                    .t_target = t_target,
+                    .trace_stride = trace_stride,
+                    .mirror = mirror,
+                    .walks = mirror ? 2 : 1};
+  int walks = runs * ens.walks; // samples per histogram bin normalization
+  double s_tilt = tilt ? atof(tilt) : 0.0;
+  if (tilt) { // q = (e^s, e^-s, 1, 1) / Z
+    double q[4] = {exp(s_tilt), exp(-s_tilt), 1.0, 1.0}, Z = 0.0, cum = 0.0;
+    for (int d = 0; d < 4; d++)
+      Z += q[d];
+    for (int d = 0; d < 4; d++) {
+      ens.lw_step[d] = log(0.25 * Z / q[d]);
+      cum += q[d] / Z;
+      if (d < 3)
+        ens.thr[d] = (uint64_t)llround(cum * 4294967296.0);
+    }
+    ens.tilted = 1;
+  }
+  ens.visits = (int)opt_long(argc, argv, 1, "visits", 0) != 0;
+  long torus_L = opt_long(argc, argv, 1, "torus", 0);
+  atomic_init(&ens.next_run, 0);
+  atomic_init(&ens.failed, 0);
+  step_dist_t dist;
+  long reach = t_target;            // |x1| <= t for unit steps
+  double axis_var = 0.5 * t_target; // per-axis <x^2> at t_target
+  if (steps) {
+    if (step_dist_parse(&dist, 2, steps) != 0) {
+      fprintf(stderr, "steps: expected king, diag or dx:dy:w,... "
+                      "(weights >= 0, |dx|, |dy| <= %d)\n",
+              STEP_DIST_MAX_JUMP);
       return EXIT_FAILURE;
     }
+    double vx = step_dist_mean(&dist, 0), vy = step_dist_mean(&dist, 1);
+    reach = step_dist_max_jump(&dist) * (long)t_target;
+    double v2 = vx * vx + vy * vy; // the grid is centred on the origin
+    axis_var = 0.5 * ((step_dist_msd(&dist) - v2) * t_target +
+                      v2 * (double)t_target * t_target);
+    ens.steps = &dist;
+    printf("steps: drift (%g, %g), <r^2> = %g per step\n", vx, vy,
+           step_dist_msd(&dist));
+  }
+  hist_init(&ens.geom, reach, axis_var, bin_w);
+  size_t grid_cells = (size_t)(ens.geom.ng * ens.geom.ng) + 1; // + clipped
+  ens.pos_x = malloc((size_t)walks * sizeof(*ens.pos_x));
+  ens.pos_y = malloc((size_t)walks * sizeof(*ens.pos_y));
+  if (ens.tilted)
+    ens.lw = malloc((size_t)walks * sizeof(*ens.lw));
+  if (!ens.pos_x || !ens.pos_y || (ens.tilted && !ens.lw) ||
+      tacc_init(&ens.moments, nthreads, MOM_COUNT, sizeof(exact_acc_t)) ||
+      tacc_init(&ens.hx, nthreads, (size_t)ens.geom.nhx, sizeof(int64_t)) ||
+      tacc_init(&ens.grid, nthreads, grid_cells, sizeof(int64_t)) != 0) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    ens_free(&ens);
+    return EXIT_FAILURE;
+  }
 
-    // Reset position to origin for each new run
-    pos = (strc){0, 0, 0, 0};
-
-    // Generate fresh, independent seeds for this run
-    // Each run gets a unique pair of seeds from the seed generator
-    unsigned int seed1 = generate_seed();
-    unsigned int seed2 = generate_seed();
-    myrand_init(seed1, seed2);
-
-    FILE *ft = NULL;
-    if (run == 0)
-      ft = fopen("../results/dat/2d_ran_walk_trace.dat", "w");
-
-    /*====================================================================
-     * RANDOM WALK LOOP - Execute single random walk trajectory
-     *====================================================================*/
-    for (pos.step = 0; pos.step < iterations; pos.step++) {
-      // Generate random number in [0, 1) to determine step direction
-      long double r = myrand();
+  // S(t) output times: log-spaced, distinct, up to the walk length
+  if (ens.visits) {
+    int cap = VISIT_POINTS_PER_DECADE * (int)ceil(log10(iterations) + 1) + 1;
+    ens.vis_t = malloc((size_t)cap * sizeof(*ens.vis_t));
+    if (!ens.vis_t) {
+      fprintf(stderr, "Memory allocation failed.\n");
+      ens_free(&ens);
+      return EXIT_FAILURE;
+    }
+    for (int i = 0; ens.nvis < cap; i++) {
+      long t = lround(pow(10.0, (double)i / VISIT_POINTS_PER_DECADE));
+      if (t > iterations)
+        break;
+      if (ens.nvis == 0 || t > ens.vis_t[ens.nvis - 1])
+        ens.vis_t[ens.nvis++] = t;
+    }
+  }
+  if (tacc_init(&ens.vis, nthreads, ens.nvis > 0 ? 2 * (size_t)ens.nvis : 1,
+                sizeof(exact_acc_t)) != 0) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    ens_free(&ens);
+    return EXIT_FAILURE;
+  }
 
-      // Select direction based on random number (4 equally likely directions)
-      // [0, 0.25): move right  (+x direction)
-      // [0.25, 0.5): move left  (-x direction)
-      // [0.5, 0.75): move up    (+y direction)
-      // [0.75, 1): move down    (-y direction)
-      if (r < 0.25)
-        pos.x += lattice_step;
-      else if (r < 0.5)
-        pos.x -= lattice_step;
-      else if (r < 0.75)
-        pos.y += lattice_step;
-      else
-        pos.y -= lattice_step;
-
-      // Increment time counter (so we can check equality properly since it
-      // starts at 0)
-      pos.time++;
-
-      // Record position data when target time is reached
-      // This allows statistical analysis of position distribution at fixed time
-      if (pos.time == t_target) {
-        sum_vals_x += pos.x; // Accumulate x-positions for mean calculation
-        sum_vals_y += pos.y; // Accumulate x-positions for mean calculation
-        // Write: run_number, time, step, x_position
-        fprintf(fp, "%d %d %d %ld %ld\n", run, pos.time, pos.step, pos.x,
-                pos.y);
-      }
+  levy_table_t levy_tab;
+  if (levy) {
+    if (levy_table_init(&levy_tab, atof(levy)) != 0) {
+      fprintf(stderr, "levy: need %g <= alpha <= 2\n", LEVY_ALPHA_MIN);
+      ens_free(&ens);
+      return EXIT_FAILURE;
+    }
+    ens.levy = &levy_tab;
+    if ((ens.nlevy = levy_times(iterations, &ens.levy_t)) < 0) {
+      fprintf(stderr, "Memory allocation failed.\n");
+      ens_free(&ens);
+      return EXIT_FAILURE;
+    }
+  }
+  if (tacc_init(&ens.lstats, nthreads, ens.nlevy > 0 ? (size_t)ens.nlevy : 1,
+                sizeof(levy_stats_t)) != 0) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    ens_free(&ens);
+    return EXIT_FAILURE;
+  }
 
-      // Optional: Record all steps (currently commented out)
-      // Uncomment to save complete trajectory data
-      if (ft)
-        fprintf(ft, "%d %ld %ld\n", pos.time, pos.x, pos.y);
+  uint32_t *env = NULL;
+  if (env_L > 0) { // built once, before the walker threads start
+    env = env_build(env_L, disorder,
+                    (uint64_t)opt_long(argc, argv, 1, "env_seed", 1));
+    if (!env) {
+      fprintf(stderr, "Memory allocation failed.\n");
+      ens_free(&ens);
+      return EXIT_FAILURE;
     }
+    ens.env = env;
+    ens.env_L = env_L;
+    printf("environment: %ld x %ld torus, disorder %g, %.1f MiB shared by "
+           "%d threads\n",
+           env_L, env_L, disorder,
+           (double)(env_L * env_L) * sizeof(*env) / 1048576.0, nthreads);
+  }
 
-    if (ft)
-      fclose(ft);
-    fclose(fp);
-    printf("Run %d complete (seeds: %u, %u)\n", run + 1, seed1, seed2);
+  if (torus_L > 0) {
+    int status = cover_main(&ens, torus_L, nthreads);
+    ens_free(&ens);
+    return status;
+  }
+  if (ens.levy) {
+    int status = levy_main(&ens, nthreads);
+    ens_free(&ens);
+    return status;
+  }
+
+  // Output files are owned by the writer thread: per-run data in append
+  // mode (accumulates data from all runs), trajectory of the first run.
+  // One ring per walker thread plus one for the main thread.
+  rec_writer_t *writer = rw_create(nthreads + 1, RW_DEFAULT_RING);
+  if (!writer) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    ens_free(&ens);
+    free(env);
+    return EXIT_FAILURE;
   }
+  static const char *const sink_path[3] = {
+      "../results/dat/2d_ran_gen_t_100000.dat",
+      "../results/dat/2d_ran_walk_trace.dat",
+      "../results/dat/2d_ran_walk_trace_dec.bin"};
+  int run_sink = rw_add_sink(writer, sink_path[0], "a", format_run, &t_target);
+  ens.trace_sink = ens.dec_sink = -1;
+  if (run_sink >= 0)
+    ens.trace_sink = rw_add_sink(writer, sink_path[1], "w", format_trace, NULL);
+  if (ens.trace_sink >= 0)
+    ens.dec_sink =
+        rw_add_sink(writer, sink_path[2], "w", format_trace_bin, NULL);
+  int started = ens.dec_sink >= 0 && rw_start(writer) == 0;
+  if (!started) {
+    if (ens.dec_sink >= 0)
+      fprintf(stderr, "Cannot start the writer thread.\n");
+    else // the first sink that failed to open
+      perror(sink_path[run_sink < 0 ? 0 : ens.trace_sink < 0 ? 1 : 2]);
+    rw_finish(writer); // never started: closes the open files and frees
+    ens_free(&ens);
+    free(env);
+    return EXIT_FAILURE;
+  }
+  ens.writer = writer;
 
   /*========================================================================
-   * STATISTICAL ANALYSIS - Compute mean and variance of x-positions
+   * MAIN SIMULATION LOOP - independent random walks on the walker threads
    *========================================================================*/
-
-  // Reopen file for reading to compute variance
-  FILE *fp = fopen("../results/dat/2d_ran_gen_t_100000.dat", "r");
-  if (!fp) {
-    perror("fopen");
+  if (run_walkers(&ens, nthreads) != 0) {
+    rw_finish(writer);
+    ens_free(&ens);
+    free(env);
     return EXIT_FAILURE;
   }
 
-  // Variables for reading data and computing variance
-  int dummy_run, dummy_time, dummy_step, status;
-  long int x_i, y_i; // x-position from file
-  long int idx = 0;  // Counter for number of data points read
-  double mean_x = mean_funct(runs, sum_vals_x),
-         mean_y = mean_funct(runs, sum_vals_y); // Compute mean
-  double sqrdev_x = 0, sqrdev_y = 0; // Sum of squared deviations for variance
+  // merged totals are in slab 0 (exact integer sums: same as serial)
+  const exact_acc_t *mom = tacc_slab(&ens.moments, 0);
+  exact_acc_t acc_x = mom[MOM_X], acc_y = mom[MOM_Y];
+  hist2d_t hist = ens.geom;
+  hist_attach(&hist, &ens.hx, &ens.grid, 0);
 
-  // Read all recorded positions and compute squared deviations
-  while ((status = fscanf(fp, "%d %d %d %ld %ld\n", &dummy_run, &dummy_time,
-                          &dummy_step, &x_i, &y_i)) == 5) {
-    idx++;
-    sqrdev_x += (x_i - mean_x) * (x_i - mean_x); // Accumulate (x - mean)²
-    sqrdev_y += (y_i - mean_y) * (y_i - mean_y); // Accumulate (y - mean)²
+  // per-run lines and progress in run order, whatever thread ran them
+  spsc_ring_t *ring = rw_producer_ring(writer, nthreads);
+  for (int run = 0; run < runs; ++run) {
+    for (int k = 0; t_target >= 1 && t_target <= iterations && k < ens.walks;
+         k++) {
+      // Write: run_number, time, step, x_position, y_position
+      size_t w = (size_t)run * ens.walks + k;
+      rw_push(ring, run_sink, run, ens.pos_x[w], ens.pos_y[w]);
+    }
+    printf("Run %d complete (seeds: %u, %u)\n", run + 1,
+           generate_seed_at(2 * (uint64_t)run),
+           generate_seed_at(2 * (uint64_t)run + 1));
   }
 
-  // Check for file reading errors
-  if (status != EOF) {
-    perror("fscanf");
-    fclose(fp);
-    return EXIT_FAILURE;
+  int status = EXIT_SUCCESS;
+  if (rw_finish(writer) != 0) {
+    fprintf(stderr, "Trajectory output: write failed.\n");
+    status = EXIT_FAILURE;
+  } else if (atomic_load(&ens.failed)) {
+    fprintf(stderr, "Memory allocation failed (visited sites).\n");
+    status = EXIT_FAILURE;
+  } else if (ens.nvis > 0 &&
+             write_visits(&ens, "../results/dat/2d_S_t.dat") != 0) {
+    perror("../results/dat/2d_S_t.dat");
+    status = EXIT_FAILURE;
+  }
+  if (status != EXIT_SUCCESS) {
+    ens_free(&ens);
+    free(env);
+    return status;
   }
-  fclose(fp);
+
+  if (acc_x.n > 0) { // plot-ready histograms (t_target reached)
+    // tilt=s: weights per P(x1) bin, then the total, summed in run order
+    lse_acc_t *hw = NULL;
+    if (ens.tilted && !(hw = calloc((size_t)hist.nhx + 1, sizeof(*hw)))) {
+      fprintf(stderr, "Memory allocation failed.\n");
+      ens_free(&ens);
+      free(env);
+      return EXIT_FAILURE;
+    }
+    for (size_t i = 0; hw && i < (size_t)walks; i++) {
+      lse_add(&hw[floor_div(ens.pos_x[i], hist.w) - hist.hx_lo], ens.lw[i]);
+      lse_add(&hw[hist.nhx], ens.lw[i]);
+    }
+    if (ens.tilted
+            ? hist_write_px1_weighted(&hist, hw, "../results/dat/2d_P_x1.dat",
+                                      walks, t_target, s_tilt)
+            : (hist_write_px1(&hist, "../results/dat/2d_P_x1.dat", walks,
+                              t_target) ||
+               hist_write_grid(&hist, "../results/dat/2d_P_x1x2.bin",
+                               walks))) {
+      perror("histogram output");
+      free(hw);
+      ens_free(&ens);
+      free(env);
+      return EXIT_FAILURE;
+    }
+    if (ens.tilted)
+      printf("tilt %g: ESS = %.1f of %d walks, sum w / walks = %.6f\n",
+             s_tilt, lse_ess(&hw[hist.nhx]), walks,
+             exp(hw[hist.nhx].m) * hw[hist.nhx].s1 / walks);
+    free(hw);
+    if (hist_clipped(&hist) > 0)
+      printf("P(x1,x2) grid: %ld samples outside +-%g sigma\n",
+             hist_clipped(&hist), GRID_SIGMAS);
+  }
+  // antithetic estimates: pair means (r + r')/2 are independent samples
+  exact_acc_t pair[4] = {mom[MOM_PX], mom[MOM_PY], mom[MOM_PX2],
+                         mom[MOM_PY2]};
+  ens_free(&ens);
+  free(env);
+
+  /*========================================================================
+   * STATISTICAL ANALYSIS - Compute mean and variance of x-positions
+   *========================================================================*/
+
+  // Mean and sample variance follow from the exact moments: no need to
+  // read the recorded positions back from disk
+  long int idx = (long int)acc_x.n; // Number of recorded data points
+  double mean_x = exact_acc_mean(&acc_x), mean_y = exact_acc_mean(&acc_y);
 
   // Display statistical results
   printf("MEAN (x position) = %g\n", mean_x);
   printf("MEAN (y position) = %g\n", mean_y);
-  printf("x - VAR = %g\n", sqrdev_x / (idx - 1)); // Sample variance x
-  printf("y - VAR = %g\n", sqrdev_y / (idx - 1)); // Sample variance y
+  printf("x - VAR = %g\n", exact_acc_var(&acc_x)); // Sample variance x
+  printf("y - VAR = %g\n", exact_acc_var(&acc_y)); // Sample variance y
   printf("idx (processed data points): %ld\n",
          idx); // Number of data points processed
+  if (mirror && pair[0].n > 0) {
+    static const char *const names[4] = {"<x>", "<y>", "<x^2>", "<y^2>"};
+    for (int i = 0; i < 4; i++)
+      printf("%s = %g +- %g (%s pairs: %ld)\n", names[i],
+             exact_acc_mean(&pair[i]) / 2, exact_acc_err(&pair[i]) / 2, anti,
+             (long)pair[i].n);
+  }
 
   return EXIT_SUCCESS;
 }
@@ -26,6 +26,16 @@ static pcg32_random_t rng_state = {
     0xda3e39cb94b95bdbULL   // Initial increment value
 };
 
+/**
+ * @brief Generator state right after seedgen_init()
+ * 
+ * Origin of the seed stream, used by generate_seed_at() for jump-ahead.
+ */
+static pcg32_random_t origin_state = { 
+    0x853c49e6748fea9bULL,
+    0xda3e39cb94b95bdbULL
+};
+
 /**
  * @brief Seed the PCG32 generator
  * 
@@ -90,6 +100,7 @@ uint32_t pcg32_random(void) {
  */
 void seedgen_init(uint64_t state, uint64_t seq) {
     pcg32_srandom(state, seq);
+    origin_state = rng_state;
 }
 
 /**
@@ -105,6 +116,37 @@ unsigned int generate_seed(void) {
     return pcg32_random();
 }
 
+/**
+ * @brief Seed number `index` of the stream started by seedgen_init()
+ * 
+ * @param index Zero-based position in the seed stream
+ * @return unsigned int Same value as the (index+1)-th generate_seed() call
+ * 
+ * Advances a copy of the origin state by `index` LCG steps with the
+ * square-and-multiply jump-ahead (Brown, "Random Number Generation with
+ * Arbitrary Stride"), then applies the usual output step.
+ */
+unsigned int generate_seed_at(uint64_t index) {
+    uint64_t cur_mult = 6364136223846793005ULL;
+    uint64_t cur_plus = origin_state.inc;
+    uint64_t acc_mult = 1u, acc_plus = 0u;
+    while (index > 0) {
+        if (index & 1u) {
+            acc_mult *= cur_mult;
+            acc_plus = acc_plus * cur_mult + cur_plus;
+        }
+        cur_plus = (cur_mult + 1) * cur_plus;
+        cur_mult *= cur_mult;
+        index >>= 1;
+    }
+    uint64_t oldstate = acc_mult * origin_state.state + acc_plus;
+
+    // XSH-RR output of the advanced state, as in pcg32_random()
+    uint32_t xorshifted = ((oldstate >> 18u) ^ oldstate) >> 27u;
+    uint32_t rot = oldstate >> 59u;
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
 /**
  * @brief Test utility function to print n generated seeds
  * 
@@ -1,16 +1,48 @@
 /* Lattice Gas Diffusion Coefficient Simulation
  * Usage: ./program L rho num_sweeps meas_per_sweep num_samples output.dat
+ *                  [target_err=e] [max_seconds=s] [check_t=t1,t2,...]
+ *                  [min_samples=n] [steps=spec] [obstacles=c]
+ *                  [obstacle_seed=n] [drive=b]
+ *
+ * steps=spec draws the hop of each attempt from a finite step distribution
+ * ("king", "diag" or "dx:dy:w,..."; common/step_dist.h) instead of the four
+ * nearest neighbours; D(t) stays <r^2>/(4t), i.e. <dr^2>/4 at rho -> 0.
+ *
+ * obstacles=c blocks every site with probability c (own PCG stream,
+ * obstacle_seed) with an immobile obstacle. The configuration is drawn
+ * once; every sample starts from the same template and places particles
+ * with probability rho on its free sites only. An obstacle is the
+ * MY_OBSTACLE value of particleOfSite, so the hop test SITE != MY_EMPTY
+ * rejects it at no extra cost. The free sites are checked for a cluster
+ * that wraps around the torus (site percolation, c_c = 0.4073).
+ *
+ * drive=b (-1 <= b <= 1) drives the gas along x (ASEP): hops go to +x, -x,
+ * +y, -y with rates (1 + b, 1 - b, 1, 1) / 4. The integrated current
+ * j(t) = sum of Delta x / (L^2 t), the net particle flux per site and
+ * sweep, is added as two columns (value, error); on the torus the uniform
+ * state is stationary and j = rho (1 - rho) b / 2. D(t) then includes the
+ * drift term.
  */
+#include "../../common/include/cli_opts.h"
+#include "../../common/include/exact_acc.h"
+#include "../../common/include/fast_fmt.h"
+#include "../../common/include/step_dist.h"
+#include "../../common/include/torus.h"
 #include "../include/pcg32.h"
 #include "../include/seed_generator.h"
+#include <limits.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #define DIM 2 // lattice system dimension
 #define STRING_LENGTH 128
 #define MY_EMPTY (-1L)
+#define MY_OBSTACLE (-2L)
+#define OBSTACLE_SEQ 0x6f6273ULL
+#define MAX_CHECK_TIMES 16 // sweeps monitored by the sequential stopping rule
 // #define MY_DEBUG // DEBUGGING ->  enable heavy internal checks or "gcc
 // -DMY_DEBUG"
 
@@ -26,7 +58,14 @@ static long int num_sweeps, num_measurements, measurement_period, num_samples,
     meas_per_sweep;
 static char datafile[STRING_LENGTH];
 
-/* 2D lattice flattened to 1D */
+/* sequential stopping: add samples until the relative error on D(t) at the
+ * check times drops below target_rel_err or max_seconds of wall clock pass */
+static double target_rel_err, max_seconds;
+static long min_samples;
+static long checkMeas[MAX_CHECK_TIMES]; // measurement indices to monitor
+static int num_check;
+
+/* 2D lattice flattened to 1D: particle index, MY_EMPTY or MY_OBSTACLE */
 static long int *particleOfSite; // dimension: VOLUME = L*L
 #define SITE(x, y) particleOfSite[(x) * L + (y)]
 
@@ -40,12 +79,28 @@ static long int *zeroPositionOfParticle;
 static long int *truePositionOfParticle;
 #define TRUE_POS(p, mu) truePositionOfParticle[(p) * DIM + (mu)]
 
-/* neighbours for PBC */
+/* neighbours for PBC (shared with the cover-time walks, common/torus.h) */
+static torus_t torus;
 static long int *plusNeighbor;
 static long int *minusNeighbor;
-/* measurements */
-static double *averageDeltaR2;
-static double *errorDeltaR2;
+
+/* obstacles=c: MY_OBSTACLE / MY_EMPTY per site, drawn once from the PCG
+ * stream OBSTACLE_SEQ; the starting lattice of every sample (NULL without
+ * obstacles) */
+static long int *obstacleTemplate;
+static double obstacleFraction;
+
+/* drive=b: cumulative rates of +x, -x, +y (driven if b != 0) */
+static int driven;
+static double driveThr[3];
+
+/* steps=spec hop distribution, NULL for nearest-neighbour hops */
+static step_dist_t *stepDist;
+/* measurements: exact sums of Delta r^2 over the particles of each sample
+ * (ratio estimator over the particle count, see exact_acc.h) */
+static exact_ratio_t *deltaR2Acc;
+/* drive=b: exact sums of Delta x over the particles, per site */
+static exact_ratio_t *currentAcc;
 
 //=======================================================
 //  UTILITY FUNCTIONS
@@ -67,24 +122,6 @@ long int *mtrxAlloc2d(long int rows, long int cols, const char *name) {
   return mtrx;
 }
 
-// 1D array allocation (long int)
-static long int *mtrxLongIntAlloc(long int n, const char *name) {
-  size_t bytes = (size_t)n * sizeof(long int); // SIZE REQUESTED
-  long int *m = malloc(bytes);                 // MATRIX ALLOCATION
-  if (!m)                                      // CHECK MEMORY
-    handleErrAll(name, bytes);
-
-  return m;
-}
-// 1D array allocation (double)
-static double *mtrxDoubleAlloc(long int n, const char *name) {
-  size_t bytes = (size_t)n * sizeof(double);
-  double *m = malloc(bytes);
-  if (!m)
-    handleErrAll(name, bytes);
-  return m;
-}
-
 //=======================================================
 //  INITIALIZATION
 //=======================================================
@@ -95,45 +132,43 @@ void myInit(void) {
   zeroPositionOfParticle = mtrxAlloc2d(VOLUME, DIM, "zeroPositionOfParticle");
   truePositionOfParticle = mtrxAlloc2d(VOLUME, DIM, "truePositionOfParticle");
 
-  plusNeighbor = mtrxLongIntAlloc(L, "plusNeighbor");
-  minusNeighbor = mtrxLongIntAlloc(L, "minusNeighbor");
-
-  for (long int i = 0; i < L; i++) {
-    plusNeighbor[i] = i + 1;
-    minusNeighbor[i] = i - 1;
-  }
-  plusNeighbor[L - 1] = 0;
-  minusNeighbor[0] = L - 1;
+  if (torus_init(&torus, L) != 0)
+    handleErrAll("torus", 2 * (size_t)L * sizeof(long int));
+  plusNeighbor = torus.plus;
+  minusNeighbor = torus.minus;
 
   if ((num_measurements * measurement_period) != num_sweeps) {
     printf("ERROR: number of steps not a multiple number of measurements\n");
     exit(EXIT_FAILURE);
   }
 
-  averageDeltaR2 = mtrxDoubleAlloc(num_measurements, "averageDeltaR2");
-  errorDeltaR2 = mtrxDoubleAlloc(num_measurements, "errorDeltaR2");
-  /* zero measurement arrays */
-  for (long int m = 0; m < num_measurements; m++) {
-    averageDeltaR2[m] = 0.0;
-    errorDeltaR2[m] = 0.0;
-  }
+  deltaR2Acc = calloc((size_t)num_measurements, sizeof(*deltaR2Acc));
+  if (!deltaR2Acc)
+    handleErrAll("deltaR2Acc", (size_t)num_measurements * sizeof(*deltaR2Acc));
+  currentAcc = calloc((size_t)num_measurements, sizeof(*currentAcc));
+  if (!currentAcc)
+    handleErrAll("currentAcc", (size_t)num_measurements * sizeof(*currentAcc));
 }
 
 // Lattice initialization: place particles randomly with density rho
 static long int initLattice(double rho) {
   long int trueN = 0;
 
-  /* empty lattice */
-  for (long int x = 0; x < L; ++x)
-    for (long int y = 0; y < L; ++y)
-      SITE(x, y) = MY_EMPTY;
+  /* empty lattice, or the shared obstacle configuration */
+  if (obstacleTemplate)
+    memcpy(particleOfSite, obstacleTemplate,
+           (size_t)VOLUME * sizeof(*particleOfSite));
+  else
+    for (long int x = 0; x < L; ++x)
+      for (long int y = 0; y < L; ++y)
+        SITE(x, y) = MY_EMPTY;
 
   // Filling lattice with particles
   for (int x = 0; x < L; x++) {
     for (int y = 0; y < L; y++) {
-      // place particle with probability rho
+      // place particle with probability rho (free sites only)
       long double r = myrand();
-      if (r < rho) {
+      if (r < rho && SITE(x, y) == MY_EMPTY) {
         long int p = trueN;
         SITE(x, y) = p;
         POS(p, 0) = x;
@@ -173,8 +208,14 @@ void updateLattice(long int trueN) {
     long int x = POS(p, 0);
     long int y = POS(p, 1);
 
-    // 3. random direction
-    int dir = (int)(4.0 * myrand()); // 0,1,2,3
+    // 3. random direction (drive=b: biased rates by thresholds)
+    int dir;
+    if (driven) {
+      double r = myrand();
+      dir = (r >= driveThr[0]) + (r >= driveThr[1]) + (r >= driveThr[2]);
+    } else {
+      dir = (int)(4.0 * myrand()); // 0,1,2,3
+    }
 
     // error direction check
     if (dir < 0 || dir > 3) {
@@ -236,7 +277,7 @@ void updateLattice(long int trueN) {
   long int count = 0;
   for (long int x = 0; x < L; x++) {
     for (long int y = 0; y < L; y++) {
-      if (SITE(x, y) != MY_EMPTY) {
+      if (SITE(x, y) >= 0) {
         count++;
       }
     }
@@ -251,9 +292,10 @@ void updateLattice(long int trueN) {
 #endif
 }
 
-// Compute mean square displacement <Delta r^2> over all particles
+// Compute the exact sum of square displacements Delta r^2 over all particles
+// (the mean is formed at output time, see sampleStats)
 
-double measure(long int trueN) {
+int64_t measure(long int trueN) {
 #ifdef MY_DEBUG
   if (trueN <= 0) {
     fprintf(stderr, ">>>> DEBUG ERROR: trueN <= 0 in measure\n");
@@ -261,39 +303,179 @@ double measure(long int trueN) {
   }
 #endif
 
-  double sqrDist = 0.0, meanSqrShift;
+  int64_t sqrDist = 0;
   for (long int p = 0; p < trueN; ++p) {
     for (int mu = 0; mu < DIM; ++mu) {
-      double dl = (double)(TRUE_POS(p, mu) - ZERO_POS(p, mu));
+      int64_t dl = TRUE_POS(p, mu) - ZERO_POS(p, mu);
       sqrDist += dl * dl;
     }
   }
-  meanSqrShift = sqrDist / (double)trueN;
-  return meanSqrShift;
+  return sqrDist;
+}
+
+// Exact sum of the x displacements: the integrated current times L^2
+int64_t measureCurrent(long int trueN) {
+  int64_t sum = 0;
+  for (long int p = 0; p < trueN; ++p)
+    sum += TRUE_POS(p, 0) - ZERO_POS(p, 0);
+  return sum;
+}
+
+// Mean and standard error of <Delta r^2> at measurement m
+static void sampleStats(long m, double *mean, double *err) {
+  *mean = exact_ratio_mean(&deltaR2Acc[m]);
+  *err = exact_ratio_err(&deltaR2Acc[m]);
+}
+
+// Largest relative error on D(t) over the check times (D and its error
+// share the 1/(4t) factor, so this is err/mean of <Delta r^2>)
+static double maxRelErr(void) {
+  double worst = 0.0;
+  for (int c = 0; c < num_check; c++) {
+    double mean, err;
+    sampleStats(checkMeas[c], &mean, &err);
+    double rel = (mean > 0.0) ? err / mean : INFINITY;
+    if (rel > worst)
+      worst = rel;
+  }
+  return worst;
+}
+
+// Parse "t1,t2,..." into measurement indices; times must be measured sweeps
+static void parseCheckTimes(const char *list) {
+  num_check = 0;
+  if (list == NULL) { // default: the last measured sweep
+    checkMeas[num_check++] = num_measurements - 1;
+    return;
+  }
+  char *end;
+  for (const char *c = list; *c != '\0'; c = (*end == ',') ? end + 1 : end) {
+    long t = strtol(c, &end, 10);
+    if (end == c || t <= 0 || t > num_sweeps || t % measurement_period != 0 ||
+        num_check == MAX_CHECK_TIMES) {
+      fprintf(stderr,
+              "ERROR: check_t must list up to %d multiples of %ld in "
+              "[%ld, %ld]\n",
+              MAX_CHECK_TIMES, measurement_period, measurement_period,
+              num_sweeps);
+      exit(EXIT_FAILURE);
+    }
+    checkMeas[num_check++] = t / measurement_period - 1;
+  }
+}
+
+static double elapsedSeconds(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) +
+         1e-9 * (double)(now.tv_nsec - start->tv_nsec);
 }
 
 void myEnd(FILE *fp) {
   free(particleOfSite);
+  free(obstacleTemplate);
   free(positionOfParticle);
   free(zeroPositionOfParticle);
   free(truePositionOfParticle);
-  free(plusNeighbor);
-  free(minusNeighbor);
-  free(averageDeltaR2);
-  free(errorDeltaR2);
+  torus_free(&torus);
+  free(deltaR2Acc);
+  free(currentAcc);
   fclose(fp);
 }
 
+// Draw the obstacle template: each site blocked with probability c
+static long int initObstacles(double c, uint64_t seed) {
+  obstacleTemplate = mtrxAlloc2d(L, L, "obstacleTemplate");
+  pcg32_random_t rng;
+  pcg32_srandom_r(&rng, seed, OBSTACLE_SEQ);
+  long int blocked = 0;
+  for (long int s = 0; s < VOLUME; s++) {
+    int obstacle = (double)pcg32_random_r(&rng) < c * 4294967296.0;
+    obstacleTemplate[s] = obstacle ? MY_OBSTACLE : MY_EMPTY;
+    blocked += obstacle;
+  }
+  return blocked;
+}
+
+/* Free-site clusters of the obstacle template by BFS on the torus: size of
+ * the largest one, and whether any cluster wraps around (reaches a site
+ * again with an unwrapped position shifted by a multiple of L) */
+static long int percolationCheck(int *wraps) {
+  long int *queue = mtrxAlloc2d(VOLUME, 1, "queue");
+  long int *ux = mtrxAlloc2d(VOLUME, DIM, "unwrapped"); // unwrapped x, y
+  long int largest = 0;
+  for (long int s = 0; s < VOLUME; s++)
+    ux[2 * s] = LONG_MIN; // not reached yet
+  *wraps = 0;
+  for (long int s0 = 0; s0 < VOLUME; s0++) {
+    if (ux[2 * s0] != LONG_MIN || obstacleTemplate[s0] == MY_OBSTACLE)
+      continue;
+    long int head = 0, tail = 0;
+    queue[tail++] = s0;
+    ux[2 * s0] = s0 / L;
+    ux[2 * s0 + 1] = s0 % L;
+    while (head < tail) {
+      long int s = queue[head++], x = s / L, y = s % L;
+      const long int nb[4][4] = {{plusNeighbor[x], y, 1, 0},
+                                 {minusNeighbor[x], y, -1, 0},
+                                 {x, plusNeighbor[y], 0, 1},
+                                 {x, minusNeighbor[y], 0, -1}};
+      for (int d = 0; d < 4; d++) {
+        long int n = nb[d][0] * L + nb[d][1];
+        long int nx = ux[2 * s] + nb[d][2], ny = ux[2 * s + 1] + nb[d][3];
+        if (obstacleTemplate[n] == MY_OBSTACLE)
+          continue;
+        if (ux[2 * n] == LONG_MIN) {
+          ux[2 * n] = nx;
+          ux[2 * n + 1] = ny;
+          queue[tail++] = n;
+        } else if (ux[2 * n] != nx || ux[2 * n + 1] != ny) {
+          *wraps = 1; // same site, different image: the cluster wraps
+        }
+      }
+    }
+    if (tail > largest)
+      largest = tail;
+  }
+  free(queue);
+  free(ux);
+  return largest;
+}
+
+// one sweep with hops drawn from stepDist (alias table, one draw per hop)
+static void updateLatticeSteps(long int trueN) {
+  for (long int attempt = 0; attempt < trueN; ++attempt) {
+    long int p = (long int)(myrand() * (double)trueN);
+    int d = step_dist_sample(stepDist, pcg32_random_r(&pcg32_random_state));
+    long int dx = stepDist->dx[d], dy = stepDist->dy[d];
+    long int x = POS(p, 0), y = POS(p, 1);
+    long int nx = ((x + dx) % L + L) % L, ny = ((y + dy) % L + L) % L;
+
+    if (SITE(nx, ny) != MY_EMPTY) // also rejects a zero hop
+      continue;
+    SITE(nx, ny) = p;
+    SITE(x, y) = MY_EMPTY;
+    POS(p, 0) = nx;
+    POS(p, 1) = ny;
+    TRUE_POS(p, 0) += dx;
+    TRUE_POS(p, 1) += dy;
+  }
+}
+
 //=======================================================
 //  MAIN FUNCTION
 //=======================================================
 
 int main(int argc, char **argv) {
-  if (argc != 7) {
+  static const char *const options[] = {"target_err", "max_seconds", "check_t",
+                                        "min_samples", "steps",
+                                        "obstacles",   "obstacle_seed",
+                                        "drive",       NULL};
+  if (argc < 7 || !opt_check(argc, argv, 7, options)) {
     fprintf(stdout, "---- PROGRAM INSTRUCTIONS ----\n");
     fprintf(stderr,
             "Compile with: %s L rho num_sweeps meas_per_sweep num_samples "
-            "datafile\n",
+            "datafile [key=value ...]\n",
             argv[0]);
     fprintf(stdout, "L = lattice size\n");
     fprintf(
@@ -302,7 +484,23 @@ int main(int argc, char **argv) {
     fprintf(stdout, "num_sweeps = normalized clocks: 1 sweep is 1 unit time\n");
     fprintf(stdout,
             "meas_per_sweep = number of measurements done for single sweep\n");
-    fprintf(stdout, "num_samples = \n");
+    fprintf(stdout, "num_samples = number of independent lattice samples "
+                    "(upper bound in sequential mode, 0 = no bound)\n");
+    fprintf(stdout, "Optional sequential stopping (key=value):\n");
+    fprintf(stdout, "  target_err = stop when the relative error on D(t) at "
+                    "the check times is below this value\n");
+    fprintf(stdout, "  max_seconds = stop when this wall-clock budget is "
+                    "exhausted\n");
+    fprintf(stdout, "  check_t = comma separated sweeps to monitor (default: "
+                    "num_sweeps)\n");
+    fprintf(stdout, "  min_samples = samples taken before testing the "
+                    "target (default 10)\n");
+    fprintf(stdout, "  steps = hop distribution: king, diag or "
+                    "dx:dy:w,... (default nearest neighbours)\n");
+    fprintf(stdout, "  obstacles = fraction of sites blocked by immobile "
+                    "obstacles, drawn once (seed obstacle_seed)\n");
+    fprintf(stdout, "  drive = bias b in [-1, 1] of the x hops, adds the "
+                    "current j(t) (not with steps)\n");
 
     return EXIT_FAILURE;
   }
@@ -318,6 +516,46 @@ int main(int argc, char **argv) {
   num_measurements = 100;
   measurement_period = num_sweeps / num_measurements;
 
+  target_rel_err = opt_double(argc, argv, 7, "target_err", 0.0);
+  max_seconds = opt_double(argc, argv, 7, "max_seconds", 0.0);
+  min_samples = opt_long(argc, argv, 7, "min_samples", 10);
+  int sequential = (target_rel_err > 0.0 || max_seconds > 0.0);
+  if (num_samples < 0 || (num_samples == 0 && !sequential)) {
+    fprintf(stderr, "ERROR: num_samples must be positive unless target_err "
+                    "or max_seconds is given\n");
+    exit(EXIT_FAILURE);
+  }
+  if (min_samples < 2)
+    min_samples = 2; // an error estimate needs at least two samples
+  static step_dist_t dist;
+  const char *steps = opt_value(argc, argv, 7, "steps");
+  if (steps) {
+    if (step_dist_parse(&dist, DIM, steps) != 0) {
+      fprintf(stderr, "ERROR: steps: expected king, diag or dx:dy:w,... "
+                      "(weights >= 0, |dx|, |dy| <= %d)\n",
+              STEP_DIST_MAX_JUMP);
+      exit(EXIT_FAILURE);
+    }
+    stepDist = &dist;
+  }
+  double drive = opt_double(argc, argv, 7, "drive", 0.0);
+  if (!(drive >= -1.0 && drive <= 1.0) || (drive != 0.0 && stepDist)) {
+    fprintf(stderr, "ERROR: drive must be in [-1, 1] and cannot be combined "
+                    "with steps\n");
+    exit(EXIT_FAILURE);
+  }
+  if (drive != 0.0) {
+    driven = 1;
+    driveThr[0] = 0.25 * (1.0 + drive);
+    driveThr[1] = 0.5;
+    driveThr[2] = 0.75;
+  }
+  obstacleFraction = opt_double(argc, argv, 7, "obstacles", 0.0);
+  if (!(obstacleFraction >= 0.0 && obstacleFraction < 1.0)) {
+    fprintf(stderr, "ERROR: obstacles must be in [0, 1)\n");
+    exit(EXIT_FAILURE);
+  }
+
   // random seed initialization: one global seeding
   seedgen_init(12345ULL, 67890ULL);
   unsigned int seed1 = generate_seed();
@@ -326,6 +564,19 @@ int main(int argc, char **argv) {
   myrand_init(seed1, seed2);
 
   myInit();
+  parseCheckTimes(opt_value(argc, argv, 7, "check_t"));
+  long int blocked = 0, largestCluster = 0;
+  int wraps = 0;
+  if (obstacleFraction > 0.0) {
+    blocked = initObstacles(
+        obstacleFraction,
+        (uint64_t)opt_long(argc, argv, 7, "obstacle_seed", 1));
+    largestCluster = percolationCheck(&wraps);
+    printf("obstacles: %ld of %ld sites, largest free cluster %ld sites "
+           "(%s)\n",
+           blocked, VOLUME, largestCluster,
+           wraps ? "wraps around the torus" : "finite: D(t) -> 0");
+  }
   long int sweep = 0;
   FILE *fp = fopen(datafile, "w");
   if (!fp) {
@@ -333,42 +584,107 @@ int main(int argc, char **argv) {
     exit(EXIT_FAILURE);
   }
 
-  for (long int sample = 0; sample < num_samples; sample++) {
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  const char *stop_reason = "num_samples reached";
+  long int samples_done = 0;
+  double rel_err = INFINITY;
+
+  while (num_samples == 0 || samples_done < num_samples) {
     long int trueN = initLattice(rho);
 
     for (sweep = 1; sweep <= num_sweeps; sweep++) {
-      updateLattice(trueN);
+      if (stepDist)
+        updateLatticeSteps(trueN);
+      else
+        updateLattice(trueN);
 
       if (sweep > 0 && sweep % measurement_period == 0) {
         long m = sweep / measurement_period - 1; // index 0...num_meas -1
-        double deltaR2 = measure(trueN);
-
-        averageDeltaR2[m] += deltaR2;
-        errorDeltaR2[m] += deltaR2 * deltaR2; // for the variance
+        exact_ratio_add(&deltaR2Acc[m], measure(trueN), trueN);
+        if (driven)
+          exact_ratio_add(&currentAcc[m], measureCurrent(trueN), VOLUME);
+      }
+    }
+    samples_done++;
+
+    // sequential stopping rule, tested once per completed sample
+    if (sequential && samples_done >= min_samples) {
+      rel_err = maxRelErr();
+      if (target_rel_err > 0.0 && rel_err <= target_rel_err) {
+        stop_reason = "target error reached";
+        break;
+      }
+      if (max_seconds > 0.0 && elapsedSeconds(&start) >= max_seconds) {
+        stop_reason = "time budget exhausted";
+        break;
       }
     }
   }
+  if (samples_done >= 2)
+    rel_err = maxRelErr();
+  double elapsed = elapsedSeconds(&start);
+
   fprintf(
       fp,
       "# L = %ld  rho_input = %.3f  num_sweeps = %ld    num_samples = %ld\n", L,
-      rho, num_sweeps, num_samples);
+      rho, num_sweeps, samples_done);
+  if (obstacleTemplate)
+    fprintf(fp,
+            "# obstacles = %.4f  blocked = %ld  largest_free_cluster = %ld  "
+            "wraps = %d\n",
+            obstacleFraction, blocked, largestCluster, wraps);
+  if (sequential) {
+    fprintf(fp,
+            "# sequential: target_rel_err = %g  max_seconds = %g  "
+            "achieved_rel_err = %.6f  elapsed = %.3f s  stop = %s\n",
+            target_rel_err, max_seconds, rel_err, elapsed, stop_reason);
+    printf("L = %ld rho = %.3f: %ld samples, relative error on D(t) = %.6f "
+           "(%s, %.3f s)\n",
+           L, rho, samples_done, rel_err, stop_reason, elapsed);
+  }
+  if (driven)
+    fprintf(fp, "# drive = %g  (columns 6-7: current j(t) and its error)\n",
+            drive);
   fprintf(fp, "# sweep   deltaR2_mean      D_t_mean        err_deltaR2\n");
 
   // normalize averages and compute errors
   for (long m = 0; m < num_measurements; ++m) {
-    double mean = averageDeltaR2[m] / (double)num_samples;
-    double mean2 = errorDeltaR2[m] / (double)num_samples;
-    double var = mean2 - mean * mean;
-    double err = (var > 0.0) ? sqrt(var / (double)num_samples) : 0.0;
+    double mean, err;
+    sampleStats(m, &mean, &err);
 
     // t = (m+1) * measurement_period
     long sweep = (m + 1) * measurement_period;
     double D_t = mean / (4.0 * (double)sweep);
     double err_D = err / (4.0 * (double)sweep);
 
-    fprintf(fp, "%ld %.12f %.12f %.12f %.12f\n", sweep, mean, D_t, err, err_D);
+    // "%ld %.12f %.12f %.12f %.12f\n" without printf format parsing
+    char line[5 * 350];
+    size_t n = fmt_i64(line, sweep);
+    const double cols[6] = {
+        mean,
+        D_t,
+        err,
+        err_D,
+        exact_ratio_mean(&currentAcc[m]) / (double)sweep,
+        exact_ratio_err(&currentAcc[m]) / (double)sweep};
+    for (int c = 0; c < (driven ? 6 : 4); c++) {
+      line[n++] = ' ';
+      n += fmt_fixed(line + n, cols[c], 12);
+    }
+    line[n++] = '\n';
+    fwrite(line, 1, n, fp);
   }
 
+  if (driven) { // uniform stationary state: j = rho (1 - rho) b / 2
+    const exact_ratio_t *last = &deltaR2Acc[num_measurements - 1];
+    double dens = (double)last->den / ((double)last->n * (double)VOLUME);
+    printf("drive %g: j(%ld) = %.6f +- %.6f, rho (1 - rho) b / 2 = %.6f\n",
+           drive, num_sweeps,
+           exact_ratio_mean(&currentAcc[num_measurements - 1]) / num_sweeps,
+           exact_ratio_err(&currentAcc[num_measurements - 1]) / num_sweeps,
+           dens * (1.0 - dens) * drive / 2.0);
+  }
   myEnd(fp);
 
   return EXIT_SUCCESS;
@@ -391,7 +707,7 @@ static void debug_init_lattice(long int trueN) {
   for (long x = 0; x < L; x++) {
     for (long y = 0; y < L; y++) {
       long p = SITE(x, y);
-      if (p == MY_EMPTY)
+      if (p == MY_EMPTY || p == MY_OBSTACLE)
         continue;
       if (p < 0 || p >= trueN) {
         fprintf(
@@ -422,7 +738,7 @@ static void debug_init_lattice(long int trueN) {
   for (long x = 0; x < L; x++) {
     for (long y = 0; y < L; y++) {
       long p = SITE(x, y);
-      if (p == MY_EMPTY)
+      if (p == MY_EMPTY || p == MY_OBSTACLE)
         continue;
 
       seen[p]++;
@@ -0,0 +1,340 @@
+/**
+ * @file cloning.c
+ * @brief Large deviations of the walk displacement by population dynamics
+ *
+ * Estimates the scaled cumulant generating function (SCGF)
+ *
+ *   lambda(s) = lim_{t->oo} (1/t) log E[exp(s x1(t))]
+ *
+ * of the 1D walk (+-1 steps) or of the x1 coordinate of the 2D lattice walk
+ * with the cloning algorithm (Giardina, Kurchan, Peliti): a population of N
+ * walkers evolves with the unbiased step kernels of 01/02, and every `every`
+ * steps each walker is cloned or killed in proportion to its weight
+ * exp(s * Delta x1) since the previous resampling. The log of the mean
+ * weight summed over the resamplings, Lambda, estimates t * lambda(s), and
+ * the surviving population is distributed as the tilted ensemble
+ * P_s(x1) = P(x1) exp(s x1 - Lambda), so
+ *
+ *   P(x1) = P_s(x1) exp(-s x1 + Lambda)
+ *
+ * reaches tail probabilities far below 1/runs of direct sampling (for s > 0
+ * the right tail, for s < 0 the left one).
+ *
+ * Resampling is systematic (one uniform per resampling, copy numbers differ
+ * from N w_i / W by less than one) and in place: killed walkers' slots are
+ * refilled with the extra copies of cloned ones, so the population needs no
+ * second buffer. Weights exp(s * Delta) come from a table indexed by the
+ * integer displacement.
+ *
+ * Each s value is simulated by `replicas` independent populations; errors
+ * are the standard errors over replicas. The exact SCGFs are
+ * log cosh(s) (1D) and log((1 + cosh s) / 2) (2D); the tail file also lists
+ * the exact log10 P(x1) for comparison. Results carry the finite-N bias of
+ * the method (it decreases as 1/N).
+ *
+ * Output files:
+ * - <prefix>_scgf.dat: "s lambda err_lambda lambda_exact"
+ * - <prefix>_tail.dat: one block per s (gnuplot `index`), lines
+ *                      "x1 log10_P err_log10_P log10_P_exact"
+ *
+ * Usage: ./program_ld dim population steps prefix [s_min=-2] [s_max=2]
+ *                     [s_num=21] [replicas=8] [every=1] [min_count=10]
+ */
+
+#include "../../common/include/cli_opts.h"
+#include "../../common/include/pcg32.h"
+#include "../../common/include/sim_common.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*============================================================================
+ * POPULATION
+ *===========================================================================*/
+
+/**
+ * @brief Walker population of one replica
+ *
+ * x[i] is the x1 displacement of walker i, x0[i] its value at the last
+ * resampling. copies and holes are scratch arrays of the cloning step.
+ */
+typedef struct {
+  long n;
+  int32_t *x, *x0;
+  int32_t *copies, *holes;
+  double *wtab; // wtab[d + every] = exp(s * d), |d| <= every
+  int every;
+} population_t;
+
+static int pop_init(population_t *p, long n, int every) {
+  p->n = n;
+  p->every = every;
+  p->x = malloc((size_t)n * sizeof(*p->x));
+  p->x0 = malloc((size_t)n * sizeof(*p->x0));
+  p->copies = malloc((size_t)n * sizeof(*p->copies));
+  p->holes = malloc((size_t)n * sizeof(*p->holes));
+  p->wtab = malloc((size_t)(2 * every + 1) * sizeof(*p->wtab));
+  return (p->x && p->x0 && p->copies && p->holes && p->wtab) ? 0 : -1;
+}
+
+static void pop_free(population_t *p) {
+  free(p->x);
+  free(p->x0);
+  free(p->copies);
+  free(p->holes);
+  free(p->wtab);
+}
+
+/**
+ * @brief Advance every walker by one step of the 1D or 2D kernel
+ *
+ * 1D: u > 2^31 -> +1 (main_dat.c). 2D: the top two bits pick +x, -x, +y, -y
+ * (2d_ran_walk.c); only x1 is tracked, y steps leave it unchanged.
+ */
+static void pop_step(population_t *p, int dim, pcg32_random_t *rng) {
+  int32_t *x = p->x;
+  if (dim == 1) {
+    for (long i = 0; i < p->n; i++)
+      x[i] += (pcg32_random_r(rng) > 0x80000000u) ? 1 : -1;
+  } else {
+    static const int8_t dx[4] = {1, -1, 0, 0};
+    for (long i = 0; i < p->n; i++)
+      x[i] += dx[pcg32_random_r(rng) >> 30];
+  }
+}
+
+/**
+ * @brief Clone/kill walkers by their weights; return log of the mean weight
+ *
+ * Systematic resampling: with cumulative weights C_i and total W, walker i
+ * gets floor(N C_i / W + u) - floor(N C_{i-1} / W + u) copies. The copy
+ * numbers sum to N, so the slots of the walkers with no copy are exactly
+ * enough for the extra copies.
+ */
+static double pop_resample(population_t *p, pcg32_random_t *rng) {
+  long n = p->n, nholes = 0;
+  const double *wtab = p->wtab + p->every;
+  double total = 0.0;
+  for (long i = 0; i < n; i++)
+    total += wtab[p->x[i] - p->x0[i]];
+
+  double scale = (double)n / total, u = pcg32_double_r(rng), cum = 0.0;
+  long prev = 0;
+  for (long i = 0; i < n; i++) {
+    cum += wtab[p->x[i] - p->x0[i]];
+    long next = (i == n - 1) ? n : (long)floor(cum * scale + u);
+    if (next > n)
+      next = n;
+    p->copies[i] = (int32_t)(next - prev);
+    prev = next;
+    if (p->copies[i] == 0)
+      p->holes[nholes++] = (int32_t)i;
+  }
+  for (long i = 0; i < n && nholes > 0; i++)
+    for (int32_t c = 1; c < p->copies[i]; c++)
+      p->x[p->holes[--nholes]] = p->x[i];
+
+  memcpy(p->x0, p->x, (size_t)n * sizeof(*p->x));
+  return log(total / (double)n);
+}
+
+/**
+ * @brief Run one replica for `steps` steps at bias s
+ *
+ * @return Lambda, the summed log mean weights (estimate of steps * lambda)
+ */
+static double run_replica(population_t *p, int dim, long steps, double s,
+                          pcg32_random_t *rng) {
+  for (int d = -p->every; d <= p->every; d++)
+    p->wtab[d + p->every] = exp(s * d);
+  memset(p->x, 0, (size_t)p->n * sizeof(*p->x));
+  memset(p->x0, 0, (size_t)p->n * sizeof(*p->x0));
+
+  double Lambda = 0.0;
+  for (long t = 1; t <= steps; t++) {
+    pop_step(p, dim, rng);
+    if (t % p->every == 0 || t == steps)
+      Lambda += pop_resample(p, rng);
+  }
+  return Lambda;
+}
+
+/*============================================================================
+ * EXACT RESULTS
+ *===========================================================================*/
+
+static double scgf_exact(int dim, double s) {
+  return (dim == 1) ? log(cosh(s)) : log((1.0 + cosh(s)) / 2.0);
+}
+
+// log of the binomial probability C(n, k) 2^-n
+static double log_binom_half(long n, long k) {
+  return lgamma((double)n + 1) - lgamma((double)k + 1) -
+         lgamma((double)(n - k) + 1) - (double)n * M_LN2;
+}
+
+/**
+ * @brief Exact log P(x1(t) = x)
+ *
+ * 1D: binomial. 2D: k of the t steps move along x1 (binomial, p = 1/2) and
+ * form a 1D walk, summed over k in log-sum-exp form.
+ */
+static double log_p_exact(int dim, long t, long x) {
+  long ax = labs(x);
+  if (ax > t)
+    return -INFINITY;
+  if (dim == 1)
+    return ((t + x) % 2 == 0) ? log_binom_half(t, (t + x) / 2) : -INFINITY;
+
+  double m = -INFINITY, sum = 0.0;
+  for (long k = ax; k <= t; k += 2) {
+    double l = log_binom_half(t, k) + log_binom_half(k, (k + x) / 2);
+    if (l > m) {
+      sum = sum * exp(m - l) + 1.0;
+      m = l;
+    } else {
+      sum += exp(l - m);
+    }
+  }
+  return m + log(sum);
+}
+
+/*============================================================================
+ * MAIN
+ *===========================================================================*/
+
+int main(int argc, char **argv) {
+  static const char *const options[] = {"s_min",    "s_max", "s_num",
+                                        "replicas", "every", "min_count",
+                                        NULL};
+  if (argc < 5 || !opt_check(argc, argv, 5, options)) {
+    fprintf(stderr,
+            "Usage: %s dim population steps prefix [s_min=-2] [s_max=2] "
+            "[s_num=21]\n       [replicas=8] [every=1] [min_count=10]\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+  int dim = atoi(argv[1]);
+  long n = atol(argv[2]), steps = atol(argv[3]);
+  const char *prefix = argv[4];
+  double s_min = opt_double(argc, argv, 5, "s_min", -2.0);
+  double s_max = opt_double(argc, argv, 5, "s_max", 2.0);
+  long s_num = opt_long(argc, argv, 5, "s_num", 21);
+  long replicas = opt_long(argc, argv, 5, "replicas", 8);
+  long every = opt_long(argc, argv, 5, "every", 1);
+  long min_count = opt_long(argc, argv, 5, "min_count", 10);
+  if ((dim != 1 && dim != 2) || n < 2 || steps < 1 || s_num < 1 ||
+      replicas < 2 || every < 1 || every > steps || steps > INT32_MAX) {
+    fprintf(stderr, "Invalid parameters (dim 1 or 2, population >= 2, "
+                    "replicas >= 2, 1 <= every <= steps)\n");
+    return EXIT_FAILURE;
+  }
+
+  char path[SIM_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s_scgf.dat", prefix);
+  FILE *fs = fopen(path, "w");
+  if (!fs) {
+    perror(path);
+    return EXIT_FAILURE;
+  }
+  snprintf(path, sizeof(path), "%s_tail.dat", prefix);
+  FILE *ft = fopen(path, "w");
+  if (!ft) {
+    perror(path);
+    fclose(fs);
+    return EXIT_FAILURE;
+  }
+
+  // histogram of x1 in [-steps, steps]: per replica counts, and over
+  // replicas the moments of q_r(x) = h_r(x)/N * exp(Lambda_r - Lambda_0)
+  long nx = 2 * steps + 1;
+  population_t pop;
+  int64_t *h = malloc((size_t)nx * sizeof(*h));
+  int64_t *htot = malloc((size_t)nx * sizeof(*htot));
+  double *q1 = malloc((size_t)nx * sizeof(*q1));
+  double *q2 = malloc((size_t)nx * sizeof(*q2));
+  if (pop_init(&pop, n, (int)every) != 0 || !h || !htot || !q1 || !q2) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    fclose(fs);
+    fclose(ft);
+    pop_free(&pop);
+    free(h);
+    free(htot);
+    free(q1);
+    free(q2);
+    return EXIT_FAILURE;
+  }
+
+  fprintf(fs, "# dim = %d  N = %ld  t = %ld  replicas = %ld  every = %ld\n",
+          dim, n, steps, replicas, every);
+  fprintf(fs, "# s   lambda   err_lambda   lambda_exact\n");
+  for (long k = 0; k < s_num; k++) {
+    double s = (s_num == 1) ? s_min
+                            : s_min + (s_max - s_min) * k / (double)(s_num - 1);
+    double lam1 = 0.0, lam2 = 0.0, Lambda0 = 0.0;
+    memset(htot, 0, (size_t)nx * sizeof(*htot));
+    memset(q1, 0, (size_t)nx * sizeof(*q1));
+    memset(q2, 0, (size_t)nx * sizeof(*q2));
+
+    for (long r = 0; r < replicas; r++) {
+      // one stream per (s, replica)
+      pcg32_random_t rng;
+      pcg32_srandom_r(&rng, SIM_SEED_STATE,
+                      SIM_SEED_SEQ + (uint64_t)(k * replicas + r));
+      double Lambda = run_replica(&pop, dim, steps, s, &rng);
+      double lam = Lambda / (double)steps;
+      lam1 += lam;
+      lam2 += lam * lam;
+      if (r == 0)
+        Lambda0 = Lambda;
+
+      memset(h, 0, (size_t)nx * sizeof(*h));
+      for (long i = 0; i < n; i++)
+        h[pop.x[i] + steps]++;
+      double f = exp(Lambda - Lambda0) / (double)n;
+      for (long j = 0; j < nx; j++) {
+        if (h[j] == 0)
+          continue;
+        double q = (double)h[j] * f;
+        htot[j] += h[j];
+        q1[j] += q;
+        q2[j] += q * q;
+      }
+    }
+
+    double R = (double)replicas;
+    double lam_mean = lam1 / R;
+    double lam_var = (lam2 / R - lam_mean * lam_mean) * R / (R - 1.0);
+    fprintf(fs, "%.4f %.10f %.10f %.10f\n", s, lam_mean,
+            sqrt(lam_var > 0 ? lam_var / R : 0.0), scgf_exact(dim, s));
+
+    // reweighted P(x1) where this bias puts enough walkers
+    fprintf(ft, "# s = %.4f  lambda = %.10f\n", s, lam_mean);
+    fprintf(ft, "# x1   log10_P   err_log10_P   log10_P_exact\n");
+    for (long j = 0; j < nx; j++) {
+      if (htot[j] < min_count)
+        continue;
+      long x = j - steps;
+      double qm = q1[j] / R;
+      double qv = (q2[j] / R - qm * qm) * R / (R - 1.0);
+      double lp = log(qm) - s * (double)x + Lambda0;
+      double err = sqrt(qv > 0 ? qv / R : 0.0) / qm;
+      fprintf(ft, "%ld %.8f %.8f %.8f\n", x, lp / M_LN10, err / M_LN10,
+              log_p_exact(dim, steps, x) / M_LN10);
+    }
+    fprintf(ft, "\n\n");
+    printf("s = %+.3f  lambda = %.6f (exact %.6f)\n", s, lam_mean,
+           scgf_exact(dim, s));
+  }
+
+  fclose(fs);
+  fclose(ft);
+  pop_free(&pop);
+  free(h);
+  free(htot);
+  free(q1);
+  free(q2);
+  return EXIT_SUCCESS;
+}
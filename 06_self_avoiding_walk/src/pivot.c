@@ -0,0 +1,337 @@
+/**
+ * @file pivot.c
+ * @brief Self-avoiding walks on the square lattice by the pivot algorithm
+ *
+ * Markov chain over N-step self-avoiding walks (SAWs) with the uniform
+ * distribution as stationary measure (Madras & Sokal): pick a site k of the
+ * walk uniformly among 1..N-1 and one of the 7 non-identity symmetries g of
+ * the square lattice (the D4 group of the antithetic partners of 02), apply
+ * g around w[k] to one side of the walk and accept if the result is still
+ * self-avoiding. The chain starts from the straight rod, whose memory
+ * fades only after O(N) attempts: the default burn-in is the larger of
+ * attempts/10 and BURNIN_PER_SITE * N.
+ *
+ * Occupancy is an open-addressing hash (linear probing, power-of-two table
+ * at most half full) from site to walk index. Entries are never deleted: an
+ * entry (site, i) counts only while w[i] == site, so an accepted pivot just
+ * overwrites the entries of the moved sites and stale ones are dropped when
+ * the table is rebuilt. Each pivot moves the shorter side of the walk (the
+ * end-to-end vector does not care which side is held fixed) and checks the
+ * moved sites outward from the pivot, where collisions are most likely;
+ * rejected pivots, the large majority for long walks, therefore stop after
+ * a few sites, and accepted ones cost at most N/2. The mean cost per
+ * attempt grows like the acceptance fraction times N, i.e. as N^0.81.
+ *
+ * The squared end-to-end distance R^2 = |w[N] - w[0]|^2 is recorded after
+ * every attempt (O(1)). Successive samples are strongly correlated, so the
+ * error comes from a blocking analysis: block means of 2^l samples for
+ * every level l, accumulated on the fly in O(log attempts) memory. The
+ * reported error is the largest over levels with at least MIN_BLOCKS
+ * blocks (the plateau of the blocking curve), and the integrated
+ * autocorrelation time is tau_int = (err / err_0)^2 / 2, err_0 being the
+ * naive error of the uncorrelated estimate.
+ *
+ * Output files:
+ * - <prefix>_R2.dat (appended, one line per N):
+ *   "N <R^2> err tau_int acceptance <R^2>/N^(3/2)"
+ * - <prefix>_N<N>_binning.dat: "level block_size blocks err tau_int"
+ *
+ * Usage: ./program_saw N attempts prefix [burnin=max(attempts/10, 20 N)]
+ */
+
+#include "../../common/include/cli_opts.h"
+#include "../../common/include/pcg32.h"
+#include "../../common/include/sim_common.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LEVELS 64  // blocking levels (block sizes 2^0 .. 2^63)
+#define MIN_BLOCKS 128 // blocks a level needs to enter the error estimate
+#define BURNIN_PER_SITE 20 // default burn-in attempts per step of the walk
+#define MAX_N (1L << 28)   // walk length limit
+#define RECENTRE (1L << 29) // rebuild once w[0] drifts this far
+
+/* Non-identity lattice symmetries {a, b, c, d}: (x, y) -> (a x + b y,
+ * c x + d y) */
+static const int symmetries[7][4] = {
+    {0, -1, 1, 0},  // rot90
+    {-1, 0, 0, -1}, // rot180
+    {0, 1, -1, 0},  // rot270
+    {1, 0, 0, -1},  // mirror_x
+    {-1, 0, 0, 1},  // mirror_y
+    {0, 1, 1, 0},   // diag
+    {0, -1, -1, 0}, // antidiag
+};
+
+/*============================================================================
+ * SITE HASH
+ *===========================================================================*/
+
+typedef struct {
+  uint64_t key; // site packed as (uint32 x) << 32 | (uint32 y)
+  long idx;     // walk index, -1 = empty slot
+} slot_t;
+
+typedef struct {
+  slot_t *slot;
+  size_t mask;    // table size - 1
+  size_t used;    // occupied slots (live or stale)
+  long *x, *y;    // the walk w[0..N]
+  long N;
+} saw_t;
+
+static inline uint64_t site_key(long x, long y) {
+  return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
+
+static inline size_t site_hash(uint64_t key, size_t mask) {
+  return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+/**
+ * @brief Walk index occupying (x, y), or -1 if the site is free
+ */
+static inline long saw_lookup(const saw_t *w, long x, long y) {
+  uint64_t key = site_key(x, y);
+  for (size_t h = site_hash(key, w->mask); w->slot[h].idx >= 0;
+       h = (h + 1) & w->mask)
+    if (w->slot[h].key == key) {
+      long i = w->slot[h].idx;
+      return (w->x[i] == x && w->y[i] == y) ? i : -1;
+    }
+  return -1;
+}
+
+// Point the entry of (x, y) at walk index i, adding it if missing
+static inline void saw_store(saw_t *w, long x, long y, long i) {
+  uint64_t key = site_key(x, y);
+  size_t h = site_hash(key, w->mask);
+  for (; w->slot[h].idx >= 0; h = (h + 1) & w->mask)
+    if (w->slot[h].key == key) {
+      w->slot[h].idx = i;
+      return;
+    }
+  w->slot[h] = (slot_t){key, i};
+  w->used++;
+}
+
+/**
+ * @brief Drop stale entries: recentre the walk on w[0] = 0, refill the table
+ *
+ * Recentring (also forced once w[0] drifts beyond RECENTRE) keeps the
+ * coordinates well inside the 32-bit halves of the key.
+ */
+static void saw_rebuild(saw_t *w) {
+  long x0 = w->x[0], y0 = w->y[0];
+  memset(w->slot, 0xff, (w->mask + 1) * sizeof(*w->slot));
+  w->used = 0;
+  for (long i = 0; i <= w->N; i++) {
+    w->x[i] -= x0;
+    w->y[i] -= y0;
+    saw_store(w, w->x[i], w->y[i], i);
+  }
+}
+
+static int saw_init(saw_t *w, long N) {
+  size_t size = 1;
+  while (size < 4 * (size_t)(N + 1)) // at most 1/4 full after a rebuild
+    size *= 2;
+  w->N = N;
+  w->mask = size - 1;
+  w->slot = malloc(size * sizeof(*w->slot));
+  w->x = malloc((size_t)(N + 1) * sizeof(*w->x));
+  w->y = malloc((size_t)(N + 1) * sizeof(*w->y));
+  if (!w->slot || !w->x || !w->y)
+    return -1;
+  for (long i = 0; i <= N; i++) { // straight rod
+    w->x[i] = i;
+    w->y[i] = 0;
+  }
+  saw_rebuild(w);
+  return 0;
+}
+
+static void saw_free(saw_t *w) {
+  free(w->slot);
+  free(w->x);
+  free(w->y);
+}
+
+/*============================================================================
+ * PIVOT MOVE
+ *===========================================================================*/
+
+/**
+ * @brief One pivot attempt: g applied around w[k] to the shorter side
+ *
+ * @return 1 if accepted (walk updated), 0 if rejected (walk unchanged)
+ */
+static int pivot(saw_t *w, long k, const int *g) {
+  const long px = w->x[k], py = w->y[k];
+  // moved indices k + dir, k + 2 dir, ... up to `end` (inclusive)
+  const long dir = (k >= w->N / 2) ? 1 : -1, end = (dir > 0) ? w->N : 0;
+
+  for (long i = k + dir; i != end + dir; i += dir) {
+    long dx = w->x[i] - px, dy = w->y[i] - py;
+    long j = saw_lookup(w, px + g[0] * dx + g[1] * dy,
+                        py + g[2] * dx + g[3] * dy);
+    // occupied by the side that stays: self-intersection
+    if (j >= 0 && (j - k) * dir <= 0)
+      return 0;
+  }
+
+  for (long i = k + dir; i != end + dir; i += dir) {
+    long dx = w->x[i] - px, dy = w->y[i] - py;
+    w->x[i] = px + g[0] * dx + g[1] * dy;
+    w->y[i] = py + g[2] * dx + g[3] * dy;
+    saw_store(w, w->x[i], w->y[i], i);
+  }
+  if (2 * w->used > w->mask + 1 || labs(w->x[0]) > RECENTRE ||
+      labs(w->y[0]) > RECENTRE)
+    saw_rebuild(w);
+  return 1;
+}
+
+/*============================================================================
+ * BLOCKING ANALYSIS
+ *===========================================================================*/
+
+/**
+ * @struct blocking_t
+ * @brief Means of blocks of 2^l samples for every level l
+ *
+ * pending[l] holds the first half of the current level-l block; a completed
+ * block mean feeds level l + 1.
+ */
+typedef struct {
+  long double sum[MAX_LEVELS], sum2[MAX_LEVELS];
+  long n[MAX_LEVELS]; // completed blocks per level
+  double pending[MAX_LEVELS];
+  int has_pending[MAX_LEVELS];
+} blocking_t;
+
+static void blocking_add(blocking_t *b, double v) {
+  for (int l = 0; l < MAX_LEVELS; l++) {
+    b->sum[l] += v;
+    b->sum2[l] += (long double)v * v;
+    b->n[l]++;
+    if (!b->has_pending[l]) {
+      b->pending[l] = v;
+      b->has_pending[l] = 1;
+      return;
+    }
+    v = 0.5 * (b->pending[l] + v);
+    b->has_pending[l] = 0;
+  }
+}
+
+// Standard error of the mean from the level-l block means
+static double blocking_err(const blocking_t *b, int l) {
+  long n = b->n[l];
+  if (n < 2)
+    return 0.0;
+  long double mean = b->sum[l] / n;
+  long double var = (b->sum2[l] / n - mean * mean) * n / (n - 1);
+  return var > 0 ? (double)sqrtl(var / n) : 0.0;
+}
+
+/*============================================================================
+ * MAIN
+ *===========================================================================*/
+
+int main(int argc, char **argv) {
+  static const char *const options[] = {"burnin", NULL};
+  if (argc < 4 || !opt_check(argc, argv, 4, options)) {
+    fprintf(stderr,
+            "Usage: %s N attempts prefix [burnin=max(attempts/10, 20 N)]\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+  long N = atol(argv[1]), attempts = atol(argv[2]);
+  const char *prefix = argv[3];
+  long burnin = opt_long(argc, argv, 4, "burnin",
+                         (attempts / 10 > BURNIN_PER_SITE * N)
+                             ? attempts / 10
+                             : BURNIN_PER_SITE * N);
+  if (N < 2 || N > MAX_N || attempts < 1 || burnin < 0) {
+    fprintf(stderr, "Invalid parameters (2 <= N <= 2^28, attempts >= 1, "
+                    "burnin >= 0)\n");
+    return EXIT_FAILURE;
+  }
+
+  saw_t w;
+  blocking_t *b = calloc(1, sizeof(*b));
+  if (saw_init(&w, N) != 0 || !b) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    return EXIT_FAILURE;
+  }
+  pcg32_random_t rng;
+  pcg32_srandom_r(&rng, SIM_SEED_STATE, SIM_SEED_SEQ);
+
+  double t0 = sim_clock();
+  long accepted = 0;
+  for (long a = 0; a < burnin + attempts; a++) {
+    // k uniform in 1..N-1 (multiply-shift, bias < N / 2^32)
+    long k = 1 + (long)(((uint64_t)pcg32_random_r(&rng) *
+                         (uint64_t)(N - 1)) >> 32);
+    const int *g = symmetries[((uint64_t)pcg32_random_r(&rng) * 7) >> 32];
+    int acc = pivot(&w, k, g);
+    if (a < burnin)
+      continue;
+    accepted += acc;
+    long dx = w.x[N] - w.x[0], dy = w.y[N] - w.y[0];
+    blocking_add(b, (double)(dx * dx + dy * dy));
+  }
+  double secs = sim_clock() - t0;
+
+  // blocking curve; the error is its maximum over the reliable levels
+  char path[SIM_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s_N%ld_binning.dat", prefix, N);
+  FILE *fb = fopen(path, "w");
+  if (!fb) {
+    perror(path);
+    saw_free(&w);
+    free(b);
+    return EXIT_FAILURE;
+  }
+  double err0 = blocking_err(b, 0), err = err0;
+  fprintf(fb, "# N = %ld  attempts = %ld  burnin = %ld\n", N, attempts,
+          burnin);
+  fprintf(fb, "# level   block_size   blocks   err   tau_int\n");
+  for (int l = 0; l < MAX_LEVELS && b->n[l] >= 2; l++) {
+    double e = blocking_err(b, l);
+    fprintf(fb, "%d %.0f %ld %.6e %.4f\n", l, ldexp(1.0, l), b->n[l], e,
+            err0 > 0 ? 0.5 * (e / err0) * (e / err0) : 0.0);
+    if (b->n[l] >= MIN_BLOCKS && e > err)
+      err = e;
+  }
+  fclose(fb);
+
+  double mean = (double)(b->sum[0] / b->n[0]);
+  double tau = err0 > 0 ? 0.5 * (err / err0) * (err / err0) : 0.0;
+  double acc_frac = (double)accepted / (double)attempts;
+  double scaled = mean / pow((double)N, 1.5);
+  snprintf(path, sizeof(path), "%s_R2.dat", prefix);
+  FILE *fr = fopen(path, "a");
+  if (!fr) {
+    perror(path);
+    saw_free(&w);
+    free(b);
+    return EXIT_FAILURE;
+  }
+  fprintf(fr, "%ld %.8e %.8e %.4f %.6f %.8f\n", N, mean, err, tau, acc_frac,
+          scaled);
+  fclose(fr);
+
+  printf("N = %ld: <R^2> = %.6g +- %.3g, <R^2>/N^1.5 = %.5f +- %.5f\n", N,
+         mean, err, scaled, err / pow((double)N, 1.5));
+  printf("tau_int = %.2f attempts, acceptance = %.4f\n", tau, acc_frac);
+  printf("%ld attempts in %.3f s (%.3g us/attempt)\n", burnin + attempts,
+         secs, 1e6 * secs / (double)(burnin + attempts));
+  saw_free(&w);
+  free(b);
+  return EXIT_SUCCESS;
+}
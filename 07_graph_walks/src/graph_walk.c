@@ -0,0 +1,641 @@
+/**
+ * @file graph_walk.c
+ * @brief Simple random walks on arbitrary graphs stored in CSR form
+ *
+ * The graph is undirected and held in compressed sparse row form: off[v] ..
+ * off[v + 1] - 1 index the sorted neighbour list of v in adj[]. Self-loops
+ * and repeated edges are dropped when the CSR is built. Graphs:
+ * - lattice:L            the L x L torus of the lattice gas (4 neighbours)
+ * - regular:n:k          random k-regular graph, configuration model (the
+ *                        few self-loops and multi-edges are dropped)
+ * - smallworld:n:k:p     Watts-Strogatz ring: k neighbours on each side,
+ *                        every edge rewired to a uniform node with prob. p
+ * - edges:path           edge list "u v" per line (0-based, '#' comments)
+ *
+ * Node order: order=rcm (default) relabels the nodes by reverse
+ * Cuthill-McKee, a BFS from a low-degree node per component that enqueues
+ * neighbours by increasing degree, reversed; order=bfs is the plain BFS;
+ * order=none keeps the input labels. Neighbours then get nearby labels, so
+ * a walker's next node and the entries a node pulls from in the SpMV below
+ * mostly sit in cache lines already loaded. The mean label distance over
+ * edges is printed before and after.
+ *
+ * Walkers: `walkers` simple random walks (uniform neighbour, one 32-bit
+ * draw and a multiply-high per step) start on uniform nodes, or all on
+ * start=v. They are advanced WALK_BATCH at a time, one step of every walker
+ * of the batch per time step, so the adjacency loads of different walkers
+ * are independent and overlap. Per time step the number of walkers back on
+ * their start node gives the return probability P_0(t).
+ *
+ * Mixing: the distribution of the lazy walk (stay with probability 1/2)
+ * from the start node (start=v, default node 0) is evolved exactly by a
+ * pull SpMV, p'(v) = p(v) / 2 + sum over u ~ v of p(u) / (2 deg u), for up
+ * to mix_steps steps or until it is within MIX_TV_STOP of stationarity.
+ * The total variation distance to pi(v) = deg v / 2m (m = edges of the
+ * start's component) gives the mixing time t_mix(1/4).
+ *
+ * Output files:
+ * - <prefix>_return.dat: "t P_0(t) err" (walkers, err binomial)
+ * - <prefix>_mixing.dat: "t TV(p_t, pi) p_t(start) pi(start)" (lazy walk)
+ *
+ * Usage: ./program_graph graph walkers steps prefix [order=rcm|bfs|none]
+ *                        [start=v] [mix_steps=steps]
+ */
+
+#include "../../common/include/cli_opts.h"
+#include "../../common/include/pcg32.h"
+#include "../../common/include/sim_common.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_LENGTH 256       // one "u v" line of an edge list
+#define GRAPH_SEQ 0x677261ULL // PCG stream of the generated graphs
+#define WALK_BATCH 1024       // walkers advanced together
+#define MIX_TV_STOP 1e-6      // stop the SpMV once this close to pi
+#define MAX_NODES 0xfffffffeL // node labels are uint32_t
+
+typedef struct {
+  uint32_t n;    // nodes
+  size_t *off;   // n + 1 row offsets
+  uint32_t *adj; // off[n] neighbour entries (2 per edge)
+} csr_t;
+
+// growable edge list
+typedef struct {
+  uint32_t *u, *v;
+  size_t m, cap;
+} edges_t;
+
+static int edges_add(edges_t *e, uint32_t u, uint32_t v) {
+  if (e->m == e->cap) {
+    size_t cap = e->cap ? 2 * e->cap : 1024;
+    uint32_t *nu = realloc(e->u, cap * sizeof(*nu));
+    if (!nu)
+      return -1;
+    e->u = nu;
+    uint32_t *nv = realloc(e->v, cap * sizeof(*nv));
+    if (!nv)
+      return -1;
+    e->v = nv;
+    e->cap = cap;
+  }
+  e->u[e->m] = u;
+  e->v[e->m++] = v;
+  return 0;
+}
+
+static inline uint32_t uniform_below(pcg32_random_t *rng, uint32_t n) {
+  return (uint32_t)(((uint64_t)pcg32_random_r(rng) * n) >> 32);
+}
+
+static inline size_t degree(const csr_t *g, uint32_t v) {
+  return g->off[v + 1] - g->off[v];
+}
+
+/*============================================================================
+ * CSR CONSTRUCTION
+ *===========================================================================*/
+
+static int cmp_u32(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+// sort a neighbour list (insertion sort for the usual short rows)
+static void sort_row(uint32_t *a, size_t n) {
+  if (n > 32) {
+    qsort(a, n, sizeof(*a), cmp_u32);
+    return;
+  }
+  for (size_t i = 1; i < n; i++) {
+    uint32_t x = a[i];
+    size_t j = i;
+    for (; j > 0 && a[j - 1] > x; j--)
+      a[j] = a[j - 1];
+    a[j] = x;
+  }
+}
+
+/**
+ * @brief Undirected CSR of n nodes from an edge list
+ *
+ * Rows are sorted; self-loops and repeated edges are dropped.
+ *
+ * @return 0 on success, -1 if out of memory
+ */
+static int csr_build(csr_t *g, uint32_t n, const edges_t *e) {
+  g->n = n;
+  g->off = calloc((size_t)n + 1, sizeof(*g->off));
+  if (!g->off)
+    return -1;
+  for (size_t i = 0; i < e->m; i++)
+    if (e->u[i] != e->v[i]) {
+      g->off[e->u[i] + 1]++;
+      g->off[e->v[i] + 1]++;
+    }
+  for (uint32_t v = 0; v < n; v++)
+    g->off[v + 1] += g->off[v];
+  g->adj = malloc((g->off[n] ? g->off[n] : 1) * sizeof(*g->adj));
+  size_t *fill = malloc((size_t)n * sizeof(*fill));
+  if (!g->adj || !fill) {
+    free(fill);
+    return -1;
+  }
+  memcpy(fill, g->off, (size_t)n * sizeof(*fill));
+  for (size_t i = 0; i < e->m; i++)
+    if (e->u[i] != e->v[i]) {
+      g->adj[fill[e->u[i]]++] = e->v[i];
+      g->adj[fill[e->v[i]]++] = e->u[i];
+    }
+  free(fill);
+
+  // sort every row and squeeze out the duplicates in place
+  size_t w = 0, start = 0;
+  for (uint32_t v = 0; v < n; v++) {
+    size_t end = g->off[v + 1];
+    sort_row(g->adj + start, end - start);
+    g->off[v] = w;
+    for (size_t i = start; i < end; i++)
+      if (i == start || g->adj[i] != g->adj[i - 1])
+        g->adj[w++] = g->adj[i];
+    start = end;
+  }
+  g->off[n] = w;
+  return 0;
+}
+
+static void csr_free(csr_t *g) {
+  free(g->off);
+  free(g->adj);
+}
+
+/*============================================================================
+ * GRAPHS
+ *===========================================================================*/
+
+static int gen_lattice(edges_t *e, long L) {
+  for (long x = 0; x < L; x++)
+    for (long y = 0; y < L; y++) {
+      uint32_t s = (uint32_t)(x * L + y);
+      if (edges_add(e, s, (uint32_t)(((x + 1) % L) * L + y)) != 0 ||
+          edges_add(e, s, (uint32_t)(x * L + (y + 1) % L)) != 0)
+        return -1;
+    }
+  return 0;
+}
+
+// configuration model: n k stubs, shuffled and paired
+static int gen_regular(edges_t *e, uint32_t n, long k, pcg32_random_t *rng) {
+  size_t stubs = (size_t)n * (size_t)k;
+  uint32_t *s = malloc(stubs * sizeof(*s));
+  if (!s)
+    return -1;
+  for (size_t i = 0; i < stubs; i++)
+    s[i] = (uint32_t)(i / (size_t)k);
+  for (size_t i = stubs - 1; i > 0; i--) { // Fisher-Yates
+    size_t j = (size_t)(((uint64_t)pcg32_random_r(rng) << 32 |
+                         pcg32_random_r(rng)) %
+                        (i + 1));
+    uint32_t t = s[i];
+    s[i] = s[j];
+    s[j] = t;
+  }
+  for (size_t i = 0; i + 1 < stubs; i += 2)
+    if (edges_add(e, s[i], s[i + 1]) != 0) {
+      free(s);
+      return -1;
+    }
+  free(s);
+  return 0;
+}
+
+static int gen_smallworld(edges_t *e, uint32_t n, long k, double p,
+                          pcg32_random_t *rng) {
+  uint32_t thr = (uint32_t)fmin(p * 4294967296.0, 4294967295.0);
+  for (uint32_t u = 0; u < n; u++)
+    for (long j = 1; j <= k; j++) {
+      uint32_t v = (uint32_t)((u + (uint64_t)j) % n);
+      if (p > 0.0 && pcg32_random_r(rng) <= thr)
+        v = uniform_below(rng, n);
+      if (edges_add(e, u, v) != 0)
+        return -1;
+    }
+  return 0;
+}
+
+// "u v" per line; returns the node count (max label + 1), 0 on error
+static uint32_t read_edges(edges_t *e, const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    perror(path);
+    return 0;
+  }
+  char line[LINE_LENGTH];
+  long max = -1, lineno = 0;
+  while (fgets(line, sizeof(line), f)) {
+    lineno++;
+    long u, v;
+    if (line[0] == '#' || line[0] == '\n')
+      continue;
+    if (sscanf(line, "%ld %ld", &u, &v) != 2 || u < 0 || v < 0 ||
+        u >= MAX_NODES || v >= MAX_NODES) {
+      fprintf(stderr, "%s:%ld: expected \"u v\"\n", path, lineno);
+      fclose(f);
+      return 0;
+    }
+    if (edges_add(e, (uint32_t)u, (uint32_t)v) != 0) {
+      fprintf(stderr, "Memory allocation failed.\n");
+      fclose(f);
+      return 0;
+    }
+    max = u > max ? u : max;
+    max = v > max ? v : max;
+  }
+  fclose(f);
+  return (uint32_t)(max + 1);
+}
+
+/**
+ * @brief Build the graph of a specification (see the file comment)
+ *
+ * @return 0 on success, -1 on a bad specification or out of memory
+ */
+static int graph_make(csr_t *g, const char *spec) {
+  edges_t e = {0};
+  pcg32_random_t rng;
+  pcg32_srandom_r(&rng, SIM_SEED_STATE, GRAPH_SEQ);
+  long L = 0, n = 0, k = 0;
+  double p = 0.0;
+  int rc = -1;
+  uint32_t nodes = 0;
+  if (sscanf(spec, "lattice:%ld", &L) == 1 && L >= 2 && L * L <= MAX_NODES) {
+    nodes = (uint32_t)(L * L);
+    rc = gen_lattice(&e, L);
+  } else if (sscanf(spec, "regular:%ld:%ld", &n, &k) == 2 && n >= 2 &&
+             n <= MAX_NODES && k >= 1 && k < n && (n * k) % 2 == 0) {
+    nodes = (uint32_t)n;
+    rc = gen_regular(&e, nodes, k, &rng);
+  } else if (sscanf(spec, "smallworld:%ld:%ld:%lf", &n, &k, &p) == 3 &&
+             n >= 3 && n <= MAX_NODES && k >= 1 && 2 * k < n && p >= 0.0 &&
+             p <= 1.0) {
+    nodes = (uint32_t)n;
+    rc = gen_smallworld(&e, nodes, k, p, &rng);
+  } else if (strncmp(spec, "edges:", 6) == 0) {
+    nodes = read_edges(&e, spec + 6);
+    rc = nodes > 0 ? 0 : -1;
+  } else {
+    fprintf(stderr, "graph: expected lattice:L, regular:n:k, "
+                    "smallworld:n:k:p or edges:path\n");
+  }
+  if (rc == 0 && csr_build(g, nodes, &e) != 0) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    rc = -1;
+  }
+  free(e.u);
+  free(e.v);
+  return rc;
+}
+
+/*============================================================================
+ * REORDERING
+ *===========================================================================*/
+
+/**
+ * @brief BFS order of all components, neighbours by increasing degree for
+ * RCM; order[i] = old label of new node i
+ *
+ * Every component starts from its lowest-degree node (nodes are scanned in
+ * increasing degree by a counting sort), the usual cheap stand-in for a
+ * pseudo-peripheral node. With rcm set the order is reversed at the end.
+ *
+ * @return 0 on success, -1 if out of memory
+ */
+static int bfs_order(const csr_t *g, int rcm, uint32_t *order) {
+  uint32_t n = g->n;
+  size_t max_deg = 0;
+  for (uint32_t v = 0; v < n; v++)
+    max_deg = degree(g, v) > max_deg ? degree(g, v) : max_deg;
+  size_t *count = calloc(max_deg + 2, sizeof(*count));
+  uint32_t *by_deg = malloc((size_t)n * sizeof(*by_deg));
+  uint8_t *seen = calloc(n, 1);
+  if (!count || !by_deg || !seen) {
+    free(count);
+    free(by_deg);
+    free(seen);
+    return -1;
+  }
+  for (uint32_t v = 0; v < n; v++)
+    count[degree(g, v) + 1]++;
+  for (size_t d = 0; d <= max_deg; d++)
+    count[d + 1] += count[d];
+  for (uint32_t v = 0; v < n; v++)
+    by_deg[count[degree(g, v)]++] = v;
+
+  size_t head = 0, tail = 0;
+  for (uint32_t s = 0; s < n; s++) {
+    if (seen[by_deg[s]])
+      continue;
+    seen[by_deg[s]] = 1;
+    order[tail++] = by_deg[s];
+    while (head < tail) { // order[] doubles as the BFS queue
+      uint32_t v = order[head++];
+      size_t first = tail;
+      for (size_t i = g->off[v]; i < g->off[v + 1]; i++)
+        if (!seen[g->adj[i]]) {
+          seen[g->adj[i]] = 1;
+          order[tail++] = g->adj[i];
+        }
+      for (size_t i = first + 1; rcm && i < tail; i++) { // by degree
+        uint32_t x = order[i];
+        size_t j = i;
+        for (; j > first && degree(g, order[j - 1]) > degree(g, x); j--)
+          order[j] = order[j - 1];
+        order[j] = x;
+      }
+    }
+  }
+  for (uint32_t i = 0; rcm && i < n / 2; i++) {
+    uint32_t t = order[i];
+    order[i] = order[n - 1 - i];
+    order[n - 1 - i] = t;
+  }
+  free(count);
+  free(by_deg);
+  free(seen);
+  return 0;
+}
+
+/**
+ * @brief Relabel g so that new node i is old node order[i]; rank[old] = new
+ *
+ * @return 0 on success, -1 if out of memory (g unchanged)
+ */
+static int csr_permute(csr_t *g, const uint32_t *order, uint32_t *rank) {
+  uint32_t n = g->n;
+  size_t *off = malloc(((size_t)n + 1) * sizeof(*off));
+  uint32_t *adj = malloc((g->off[n] ? g->off[n] : 1) * sizeof(*adj));
+  if (!off || !adj) {
+    free(off);
+    free(adj);
+    return -1;
+  }
+  for (uint32_t i = 0; i < n; i++)
+    rank[order[i]] = i;
+  off[0] = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    uint32_t v = order[i];
+    size_t d = degree(g, v);
+    for (size_t j = 0; j < d; j++)
+      adj[off[i] + j] = rank[g->adj[g->off[v] + j]];
+    sort_row(adj + off[i], d);
+    off[i + 1] = off[i] + d;
+  }
+  csr_free(g);
+  g->off = off;
+  g->adj = adj;
+  return 0;
+}
+
+// mean |u - v| over the edges: how far apart neighbours are stored
+static double label_distance(const csr_t *g) {
+  double sum = 0.0;
+  for (uint32_t v = 0; v < g->n; v++)
+    for (size_t i = g->off[v]; i < g->off[v + 1]; i++)
+      sum += (g->adj[i] > v) ? g->adj[i] - v : v - g->adj[i];
+  return g->off[g->n] ? sum / (double)g->off[g->n] : 0.0;
+}
+
+/*============================================================================
+ * WALKERS AND MIXING
+ *===========================================================================*/
+
+/**
+ * @brief Return counts back[t] (t = 1..steps) of `walkers` walks
+ *
+ * start < 0: every walker starts on a uniform node.
+ */
+static void walk_batches(const csr_t *g, long walkers, long steps, long start,
+                         pcg32_random_t *rng, int64_t *back) {
+  uint32_t pos[WALK_BATCH], home[WALK_BATCH];
+  const size_t *off = g->off;
+  const uint32_t *adj = g->adj;
+  for (long b0 = 0; b0 < walkers; b0 += WALK_BATCH) {
+    int nb = (walkers - b0 < WALK_BATCH) ? (int)(walkers - b0) : WALK_BATCH;
+    for (int i = 0; i < nb; i++)
+      home[i] = pos[i] = (start >= 0) ? (uint32_t)start
+                                      : uniform_below(rng, g->n);
+    for (long t = 1; t <= steps; t++) {
+      int64_t at_home = 0;
+      for (int i = 0; i < nb; i++) {
+        uint32_t v = pos[i];
+        size_t d = off[v + 1] - off[v];
+        if (d > 0) // isolated nodes keep their walker
+          v = adj[off[v] + (((uint64_t)pcg32_random_r(rng) * d) >> 32)];
+        pos[i] = v;
+        at_home += (v == home[i]);
+      }
+      back[t] += at_home;
+    }
+  }
+}
+
+/**
+ * @brief Lazy-walk distribution from `start` by SpMV, "t TV p_t(start)
+ * pi(start)" lines to f
+ *
+ * @return t_mix(1/4), -1 if not reached, -2 if out of memory
+ */
+static long mix_spmv(const csr_t *g, uint32_t start, long max_steps, FILE *f,
+                     double *tv_last, long *done) {
+  uint32_t n = g->n;
+  double *p = calloc(n, sizeof(*p)), *q = malloc((size_t)n * sizeof(*q));
+  double *pi = calloc(n, sizeof(*pi));
+  uint32_t *queue = malloc((size_t)n * sizeof(*queue));
+  if (!p || !q || !pi || !queue) {
+    free(p);
+    free(q);
+    free(pi);
+    free(queue);
+    return -2;
+  }
+  // component of the start node; pi(v) = deg v / (2 m) on it (pi marks it)
+  size_t head = 0, tail = 0;
+  double two_m = 0.0;
+  queue[tail++] = start;
+  pi[start] = 1.0;
+  while (head < tail) {
+    uint32_t v = queue[head++];
+    two_m += (double)degree(g, v);
+    for (size_t i = g->off[v]; i < g->off[v + 1]; i++)
+      if (pi[g->adj[i]] == 0.0) {
+        pi[g->adj[i]] = 1.0;
+        queue[tail++] = g->adj[i];
+      }
+  }
+  for (size_t i = 0; i < tail; i++) {
+    uint32_t v = queue[i];
+    pi[v] = two_m > 0.0 ? (double)degree(g, v) / two_m : 1.0;
+  }
+
+  long t_mix = -1, t = 0;
+  double tv = 1.0;
+  p[start] = 1.0;
+  for (t = 1; t <= max_steps && tv > MIX_TV_STOP; t++) {
+    for (uint32_t v = 0; v < n; v++) {
+      size_t d = degree(g, v);
+      q[v] = d ? 0.5 * p[v] / (double)d : 0.0;
+    }
+    tv = 0.0;
+    for (uint32_t v = 0; v < n; v++) { // pull: p'(v) from the neighbours
+      double s = degree(g, v) ? 0.5 * p[v] : p[v];
+      for (size_t i = g->off[v]; i < g->off[v + 1]; i++)
+        s += q[g->adj[i]];
+      p[v] = s; // q holds everything the later rows still need
+      tv += fabs(s - pi[v]);
+    }
+    tv *= 0.5;
+    if (t_mix < 0 && tv <= 0.25)
+      t_mix = t;
+    fprintf(f, "%ld %.10e %.10e %.10e\n", t, tv, p[start], pi[start]);
+  }
+  *tv_last = tv;
+  *done = t - 1;
+  free(p);
+  free(q);
+  free(pi);
+  free(queue);
+  return t_mix;
+}
+
+/*============================================================================
+ * MAIN
+ *===========================================================================*/
+
+int main(int argc, char **argv) {
+  static const char *const options[] = {"order", "start", "mix_steps", NULL};
+  const char *order_opt = opt_value(argc, argv, 5, "order");
+  if (!order_opt)
+    order_opt = "rcm";
+  if (argc < 5 || !opt_check(argc, argv, 5, options) ||
+      (strcmp(order_opt, "rcm") != 0 && strcmp(order_opt, "bfs") != 0 &&
+       strcmp(order_opt, "none") != 0)) {
+    fprintf(stderr,
+            "Usage: %s graph walkers steps prefix [order=rcm|bfs|none] "
+            "[start=v] [mix_steps=steps]\n"
+            "       graph: lattice:L, regular:n:k, smallworld:n:k:p or "
+            "edges:path\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+  long walkers = atol(argv[2]), steps = atol(argv[3]);
+  const char *prefix = argv[4];
+  long start = opt_long(argc, argv, 5, "start", -1);
+  long mix_steps = opt_long(argc, argv, 5, "mix_steps", steps);
+  if (walkers < 0 || steps < 1 || mix_steps < 0) {
+    fprintf(stderr, "Invalid parameters (walkers >= 0, steps >= 1, "
+                    "mix_steps >= 0)\n");
+    return EXIT_FAILURE;
+  }
+
+  double t0 = sim_clock();
+  csr_t g;
+  if (graph_make(&g, argv[1]) != 0)
+    return EXIT_FAILURE;
+  if (start >= (long)g.n) {
+    fprintf(stderr, "start: node %ld out of range (n = %u)\n", start, g.n);
+    return EXIT_FAILURE;
+  }
+  printf("graph %s: %u nodes, %zu edges, built in %.3f s\n", argv[1], g.n,
+         g.off[g.n] / 2, sim_clock() - t0);
+
+  // relabel for locality; start follows its node
+  uint32_t mix_start = (start >= 0) ? (uint32_t)start : 0;
+  if (strcmp(order_opt, "none") != 0) {
+    double before = label_distance(&g);
+    uint32_t *order = malloc((size_t)g.n * sizeof(*order));
+    uint32_t *rank = malloc((size_t)g.n * sizeof(*rank));
+    t0 = sim_clock();
+    if (!order || !rank || bfs_order(&g, order_opt[0] == 'r', order) != 0 ||
+        csr_permute(&g, order, rank) != 0) {
+      fprintf(stderr, "Memory allocation failed.\n");
+      free(order);
+      free(rank);
+      csr_free(&g);
+      return EXIT_FAILURE;
+    }
+    mix_start = rank[mix_start];
+    if (start >= 0)
+      start = rank[start];
+    printf("order=%s: mean label distance over edges %.1f -> %.1f "
+           "(%.3f s)\n",
+           order_opt, before, label_distance(&g), sim_clock() - t0);
+    free(order);
+    free(rank);
+  }
+
+  char path[SIM_PATH_LENGTH];
+  int64_t *back = calloc((size_t)steps + 1, sizeof(*back));
+  if (!back) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    csr_free(&g);
+    return EXIT_FAILURE;
+  }
+  pcg32_random_t rng;
+  pcg32_srandom_r(&rng, SIM_SEED_STATE, SIM_SEED_SEQ);
+  t0 = sim_clock();
+  walk_batches(&g, walkers, steps, start, &rng, back);
+  double secs = sim_clock() - t0;
+  snprintf(path, sizeof(path), "%s_return.dat", prefix);
+  FILE *fr = fopen(path, "w");
+  if (!fr) {
+    perror(path);
+    free(back);
+    csr_free(&g);
+    return EXIT_FAILURE;
+  }
+  fprintf(fr, "# graph = %s  walkers = %ld  start = %s  order = %s\n",
+          argv[1], walkers, start >= 0 ? "fixed" : "uniform", order_opt);
+  fprintf(fr, "# t   P_0(t)   err\n");
+  for (long t = 1; walkers > 0 && t <= steps; t++) {
+    double P = (double)back[t] / (double)walkers;
+    fprintf(fr, "%ld %.10e %.10e\n", t, P,
+            sqrt(P * (1.0 - P) / (double)walkers));
+  }
+  fclose(fr);
+  free(back);
+  printf("%ld walkers x %ld steps in %.3f s (%.3g ns/step)\n", walkers,
+         steps, secs, walkers ? 1e9 * secs / ((double)walkers * steps) : 0.0);
+
+  snprintf(path, sizeof(path), "%s_mixing.dat", prefix);
+  FILE *fm = fopen(path, "w");
+  if (!fm) {
+    perror(path);
+    csr_free(&g);
+    return EXIT_FAILURE;
+  }
+  fprintf(fm, "# graph = %s  lazy walk from node %u (%s labels)\n", argv[1],
+          mix_start, order_opt);
+  fprintf(fm, "# t   TV(p_t, pi)   p_t(start)   pi(start)\n");
+  double tv = 1.0;
+  long done = 0;
+  t0 = sim_clock();
+  long t_mix = mix_spmv(&g, mix_start, mix_steps, fm, &tv, &done);
+  secs = sim_clock() - t0;
+  fclose(fm);
+  if (t_mix == -2) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    csr_free(&g);
+    return EXIT_FAILURE;
+  }
+  if (t_mix >= 0)
+    printf("lazy walk: t_mix(1/4) = %ld", t_mix);
+  else
+    printf("lazy walk: t_mix(1/4) not reached");
+  printf(", TV = %.3g after %ld steps (%.3g ns/edge)\n", tv, done,
+         done ? 1e9 * secs / ((double)done * (double)g.off[g.n]) : 0.0);
+  csr_free(&g);
+  return EXIT_SUCCESS;
+}
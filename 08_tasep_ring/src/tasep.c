@@ -0,0 +1,222 @@
+/**
+ * @file tasep.c
+ * @brief Totally asymmetric exclusion on a ring, 64 sites per machine word
+ *
+ * N sites on a ring, M = round(rho N) particles placed uniformly (exactly M
+ * by selection sampling). Parallel update: at every time step each particle
+ * whose right neighbour is empty hops to it with probability p, all sites at
+ * once from the old configuration. The steady current per site is known in
+ * the thermodynamic limit,
+ *   J = (1 - sqrt(1 - 4 p rho (1 - rho))) / 2,
+ * which reduces to rule 184 at p = 1.
+ *
+ * kernel=bits (default) stores the occupancy as uint64 words, bit i of word
+ * w being site 64 w + i. One pass over the words updates 64 sites per step
+ * of the loop:
+ *   right  = (cur >> 1) | (next << 63)       (site i + 1 occupied)
+ *   movers = cur & ~right & B                (B: bits set with prob. p)
+ *   cur'   = (cur & ~movers) | (movers << 1) | carry
+ * The carry is the top mover of the previous word. The Bernoulli mask B
+ * compares a bit-sliced P_BITS-bit uniform per lane with round(p 2^P_BITS),
+ * most significant bit first. Only the words up to the lowest set bit of
+ * the threshold are drawn, so p = 1/2 costs one 64-bit draw per word and
+ * p = 3/4 two. kernel=scalar is the byte-per-site reference with one draw
+ * per particle that can move.
+ *
+ * The current is the number of hops per site and time step (popcount of
+ * the movers). After `burnin` steps it is averaged over `steps` steps in
+ * NBLOCKS consecutive blocks, and the error comes from the spread of the
+ * block means. The uniform start relaxes slowly (long-wavelength density
+ * modes): with too short a burn-in J sits below the exact value by more
+ * than the block error, hence the default burnin = steps.
+ *
+ * Output: <prefix>_current.dat (appended, one line per run):
+ *   "N rho p J err J_exact kernel"
+ *
+ * Usage: ./program_tasep N rho steps prefix [p=0.5] [burnin=steps]
+ *                        [kernel=bits|scalar]
+ */
+
+#include "../../common/include/cli_opts.h"
+#include "../../common/include/pcg32.h"
+#include "../../common/include/sim_common.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define P_BITS 16  // resolution of the hop probability: 2^-16
+#define NBLOCKS 32 // blocks of the current average
+
+static inline uint64_t rand64(pcg32_random_t *rng) {
+  uint64_t hi = pcg32_random_r(rng);
+  return (hi << 32) | pcg32_random_r(rng);
+}
+
+/**
+ * @brief 64 independent bits, each set with probability T / 2^P_BITS
+ *
+ * lt collects the lanes already known to be below T, eq those equal so far.
+ */
+static inline uint64_t bern_mask(pcg32_random_t *rng, uint32_t T, int low) {
+  if (T >> P_BITS)
+    return ~0ULL; // p = 1
+  uint64_t lt = 0, eq = ~0ULL;
+  for (int b = P_BITS - 1; b >= low && eq; b--) {
+    uint64_t r = rand64(rng);
+    if ((T >> b) & 1) {
+      lt |= eq & ~r;
+      eq &= r;
+    } else {
+      eq &= ~r;
+    }
+  }
+  return lt;
+}
+
+/**
+ * @brief One parallel update of the bit-packed ring of nw words
+ *
+ * @return number of hops
+ */
+static int64_t step_bits(uint64_t *occ, size_t nw, uint32_t T, int low,
+                         pcg32_random_t *rng) {
+  uint64_t first = occ[0], carry = 0;
+  int64_t hops = 0;
+  for (size_t w = 0; w < nw; w++) {
+    uint64_t cur = occ[w], next = (w + 1 < nw) ? occ[w + 1] : first;
+    uint64_t right = (cur >> 1) | (next << 63);
+    uint64_t movers = cur & ~right;
+    if (movers) // a word without movers needs no random bits
+      movers &= bern_mask(rng, T, low);
+    occ[w] = (cur & ~movers) | (movers << 1) | carry;
+    carry = movers >> 63;
+    hops += __builtin_popcountll(movers);
+  }
+  occ[0] |= carry; // the top mover of the last word wraps to site 0
+  return hops;
+}
+
+/**
+ * @brief Reference update, one byte per site and one draw per candidate
+ */
+static int64_t step_scalar(uint8_t *s, size_t n, uint32_t thr32, int always,
+                           pcg32_random_t *rng) {
+  uint8_t first = s[0], carry = 0;
+  int64_t hops = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint8_t cur = s[i], next = (i + 1 < n) ? s[i + 1] : first;
+    uint8_t move = cur && !next && (always || pcg32_random_r(rng) < thr32);
+    s[i] = (uint8_t)((cur && !move) || carry);
+    carry = move;
+    hops += move;
+  }
+  s[0] |= carry;
+  return hops;
+}
+
+int main(int argc, char **argv) {
+  static const char *const options[] = {"p", "burnin", "kernel", NULL};
+  const char *kernel = opt_value(argc, argv, 5, "kernel");
+  if (!kernel)
+    kernel = "bits";
+  if (argc < 5 || !opt_check(argc, argv, 5, options) ||
+      (strcmp(kernel, "bits") != 0 && strcmp(kernel, "scalar") != 0)) {
+    fprintf(stderr,
+            "Usage: %s N rho steps prefix [p=0.5] [burnin=steps] "
+            "[kernel=bits|scalar]\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+  long N = atol(argv[1]), steps = atol(argv[3]);
+  double rho = atof(argv[2]);
+  const char *prefix = argv[4];
+  double p = opt_double(argc, argv, 5, "p", 0.5);
+  long burnin = opt_long(argc, argv, 5, "burnin", steps);
+  if (N < 128 || N % 64 != 0 || !(rho >= 0.0 && rho <= 1.0) ||
+      steps < NBLOCKS || !(p > 0.0 && p <= 1.0) || burnin < 0) {
+    fprintf(stderr, "Invalid parameters (N >= 128 a multiple of 64, "
+                    "0 <= rho <= 1, steps >= %d, 0 < p <= 1)\n",
+            NBLOCKS);
+    return EXIT_FAILURE;
+  }
+  int bits = (kernel[0] == 'b');
+
+  // hop probability as a P_BITS-bit threshold (bits) or a 32-bit one
+  uint32_t T = (uint32_t)lround(p * (1 << P_BITS));
+  if (T == 0)
+    T = 1;
+  int low = (T >> P_BITS) ? P_BITS : __builtin_ctz(T);
+  uint32_t thr32 = (uint32_t)fmin(p * 4294967296.0, 4294967295.0);
+  int always = (p == 1.0);
+  double p_eff = bits ? (double)T / (1 << P_BITS) : p;
+
+  // exactly M particles, uniformly placed (selection sampling)
+  pcg32_random_t rng;
+  pcg32_srandom_r(&rng, SIM_SEED_STATE, SIM_SEED_SEQ);
+  long M = lround(rho * (double)N), left = M;
+  size_t nw = (size_t)N / 64;
+  uint64_t *occ = calloc(nw, sizeof(*occ));
+  uint8_t *site = calloc((size_t)N, 1);
+  if (!occ || !site) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    free(occ);
+    free(site);
+    return EXIT_FAILURE;
+  }
+  for (long i = 0; i < N && left > 0; i++)
+    if ((double)pcg32_random_r(&rng) / 4294967296.0 * (double)(N - i) <
+        (double)left) {
+      occ[i / 64] |= 1ULL << (i % 64);
+      site[i] = 1;
+      left--;
+    }
+  rho = (double)M / (double)N;
+
+  double t0 = sim_clock();
+  double block_J[NBLOCKS];
+  long per_block = steps / NBLOCKS, measured = per_block * NBLOCKS;
+  for (long t = 0; t < burnin; t++)
+    if (bits)
+      step_bits(occ, nw, T, low, &rng);
+    else
+      step_scalar(site, (size_t)N, thr32, always, &rng);
+  for (int b = 0; b < NBLOCKS; b++) {
+    int64_t hops = 0;
+    for (long t = 0; t < per_block; t++)
+      hops += bits ? step_bits(occ, nw, T, low, &rng)
+                   : step_scalar(site, (size_t)N, thr32, always, &rng);
+    block_J[b] = (double)hops / ((double)N * (double)per_block);
+  }
+  double secs = sim_clock() - t0;
+
+  double J = 0.0, var = 0.0;
+  for (int b = 0; b < NBLOCKS; b++)
+    J += block_J[b] / NBLOCKS;
+  for (int b = 0; b < NBLOCKS; b++)
+    var += (block_J[b] - J) * (block_J[b] - J) / (NBLOCKS - 1);
+  double err = sqrt(var / NBLOCKS);
+  double J_exact = 0.5 * (1.0 - sqrt(1.0 - 4.0 * p_eff * rho * (1.0 - rho)));
+
+  char path[SIM_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s_current.dat", prefix);
+  FILE *f = fopen(path, "a");
+  if (!f) {
+    perror(path);
+    free(occ);
+    free(site);
+    return EXIT_FAILURE;
+  }
+  fprintf(f, "%ld %.6f %.6f %.10f %.10f %.10f %s\n", N, rho, p_eff, J, err,
+          J_exact, kernel);
+  fclose(f);
+  printf("N = %ld rho = %.4f p = %g: J = %.6f +- %.6f (exact %.6f)\n", N, rho,
+         p_eff, J, err, J_exact);
+  printf("kernel=%s: %ld steps in %.3f s (%.3g ns per site update)\n", kernel,
+         burnin + measured, secs,
+         1e9 * secs / ((double)N * (double)(burnin + measured)));
+  free(occ);
+  free(site);
+  return EXIT_SUCCESS;
+}
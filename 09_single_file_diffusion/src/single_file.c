@@ -0,0 +1,175 @@
+/**
+ * @file single_file.c
+ * @brief Single-file diffusion: tracer statistics of 1D exclusion on a ring
+ *
+ * The 1D specialization of the lattice gas of 03: N = round(rho L)
+ * particles on a ring of L sites, placed uniformly (exactly N by selection
+ * sampling). One sweep is N attempts; each picks a uniform particle and a
+ * uniform direction, and the hop happens if the neighbouring site is empty.
+ * A free particle therefore has <x^2> = t, while a tagged particle in the
+ * file is subdiffusive (Arratia):
+ *   <Delta x^2(t)> = (1 - rho) / rho * sqrt(2 t / pi),  1 << t << L^2.
+ *
+ * Particles never pass each other, so no site array is needed. The
+ * unwrapped positions form one sorted int32 array pos[1..N], and the
+ * neighbours of particle i are pos[i - 1] and pos[i + 1]. Two ghost
+ * entries close the ring: pos[0] = pos[N] - L and pos[N + 1] = pos[1] + L,
+ * rewritten only when particle N or 1 was picked, so the hop check needs no
+ * wrap-around. An attempt is one 32-bit draw (bit 0: direction, bits 1-31:
+ * particle by multiply-high) and one neighbour load, with a branchless
+ * update:
+ *   pos[i] += d * (d * (pos[i + d] - pos[i]) > 1).
+ * For N up to several thousand the whole state stays in L1.
+ *
+ * At log-spaced sweeps (POINTS_PER_DECADE per decade) the exact sums of
+ * Delta x^2 and Delta x^4 over the particles go into ratio accumulators
+ * (exact_acc.h). One sample is one initial configuration; the errors come
+ * from the spread between samples. The initial configuration is random
+ * (annealed), which gives the prefactor above; a fixed start gives 1/sqrt(2)
+ * of it.
+ *
+ * Output: <prefix>_msd.dat:
+ *   "t <Dx^2> err <Dx^2>/sqrt(t) theory <Dx^4>/<Dx^2>^2"
+ * The last column tends to 3: the tracer is Gaussian.
+ *
+ * Usage: ./program_sfd L rho sweeps samples prefix
+ */
+
+#include "../../common/include/exact_acc.h"
+#include "../../common/include/pcg32.h"
+#include "../../common/include/sim_common.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define POINTS_PER_DECADE 10 // output times
+#define MAX_L (1L << 30)     // unwrapped positions stay within int32
+
+/**
+ * @brief One sweep of N attempts on pos[1..N] with ghosts pos[0], pos[N+1]
+ */
+static void sweep(int32_t *pos, uint32_t N, int32_t L, pcg32_random_t *rng) {
+  for (uint32_t a = 0; a < N; a++) {
+    uint32_t r = pcg32_random_r(rng);
+    uint32_t i = 1 + (uint32_t)(((uint64_t)(r >> 1) * N) >> 31);
+    int32_t d = (int32_t)(r & 1) * 2 - 1, x = pos[i];
+    pos[i] = x + d * (d * (pos[i + d] - x) > 1);
+    if (i == N)
+      pos[0] = pos[N] - L;
+    if (i == 1)
+      pos[N + 1] = pos[1] + L;
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc != 6) {
+    fprintf(stderr, "Usage: %s L rho sweeps samples prefix\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  long L = atol(argv[1]), sweeps = atol(argv[3]), samples = atol(argv[4]);
+  double rho = atof(argv[2]);
+  const char *prefix = argv[5];
+  long N = lround(rho * (double)L);
+  if (L < 2 || L > MAX_L || N < 1 || N >= L || sweeps < 1 || samples < 1) {
+    fprintf(stderr, "Invalid parameters (2 <= L <= 2^30, 1 <= rho L < L, "
+                    "sweeps >= 1, samples >= 1)\n");
+    return EXIT_FAILURE;
+  }
+  rho = (double)N / (double)L;
+
+  // log-spaced output sweeps
+  int cap = POINTS_PER_DECADE * (int)ceil(log10((double)sweeps) + 1) + 1;
+  long *times = malloc((size_t)cap * sizeof(*times));
+  int nt = 0;
+  for (int k = 0; times && nt < cap; k++) {
+    long t = lround(pow(10.0, (double)k / POINTS_PER_DECADE));
+    if (t > sweeps)
+      break;
+    if (nt == 0 || t > times[nt - 1])
+      times[nt++] = t;
+  }
+  exact_ratio_t *m2 = calloc((size_t)cap, sizeof(*m2));
+  exact_ratio_t *m4 = calloc((size_t)cap, sizeof(*m4));
+  int32_t *pos = malloc((size_t)(N + 2) * sizeof(*pos));
+  int32_t *pos0 = malloc((size_t)(N + 2) * sizeof(*pos0));
+  if (!times || !m2 || !m4 || !pos || !pos0) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    free(times);
+    free(m2);
+    free(m4);
+    free(pos);
+    free(pos0);
+    return EXIT_FAILURE;
+  }
+
+  pcg32_random_t rng;
+  pcg32_srandom_r(&rng, SIM_SEED_STATE, SIM_SEED_SEQ);
+  double t0 = sim_clock();
+  for (long s = 0; s < samples; s++) {
+    // exactly N particles, uniformly placed (selection sampling)
+    long n = 0;
+    for (long x = 0; x < L && n < N; x++)
+      if ((double)pcg32_random_r(&rng) / 4294967296.0 * (double)(L - x) <
+          (double)(N - n))
+        pos[++n] = (int32_t)x;
+    pos[0] = pos[N] - (int32_t)L;
+    pos[N + 1] = pos[1] + (int32_t)L;
+    for (long i = 1; i <= N; i++)
+      pos0[i] = pos[i];
+
+    long t = 0;
+    for (int k = 0; k < nt; k++) {
+      for (; t < times[k]; t++)
+        sweep(pos, (uint32_t)N, (int32_t)L, &rng);
+      int64_t s2 = 0, s4 = 0;
+      for (long i = 1; i <= N; i++) {
+        int64_t dx = pos[i] - pos0[i], dx2 = dx * dx;
+        s2 += dx2;
+        s4 += dx2 * dx2;
+      }
+      exact_ratio_add(&m2[k], s2, N);
+      exact_ratio_add(&m4[k], s4, N);
+    }
+  }
+  double secs = sim_clock() - t0;
+
+  char path[SIM_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s_msd.dat", prefix);
+  FILE *f = fopen(path, "w");
+  if (!f) {
+    perror(path);
+    free(times);
+    free(m2);
+    free(m4);
+    free(pos);
+    free(pos0);
+    return EXIT_FAILURE;
+  }
+  double pref = (1.0 - rho) / rho * sqrt(2.0 / M_PI);
+  fprintf(f, "# L = %ld  N = %ld  rho = %.6f  samples = %ld\n", L, N, rho,
+          samples);
+  fprintf(f, "# t   <Dx^2>   err   <Dx^2>/sqrt(t)   theory   "
+             "<Dx^4>/<Dx^2>^2\n");
+  for (int k = 0; k < nt; k++) {
+    double msd = exact_ratio_mean(&m2[k]), st = sqrt((double)times[k]);
+    fprintf(f, "%ld %.8e %.8e %.8e %.8e %.6f\n", times[k], msd,
+            exact_ratio_err(&m2[k]), msd / st, pref * st,
+            msd > 0 ? exact_ratio_mean(&m4[k]) / (msd * msd) : 0.0);
+  }
+  fclose(f);
+  double last = exact_ratio_mean(&m2[nt - 1]);
+  printf("L = %ld rho = %.4f: <Dx^2>/sqrt(t) = %.5f +- %.5f at t = %ld "
+         "(theory %.5f)\n",
+         L, rho, last / sqrt((double)times[nt - 1]),
+         exact_ratio_err(&m2[nt - 1]) / sqrt((double)times[nt - 1]),
+         times[nt - 1], pref);
+  printf("%ld samples x %ld sweeps in %.3f s (%.3g ns/attempt)\n", samples,
+         sweeps, secs, 1e9 * secs / ((double)samples * sweeps * N));
+  free(times);
+  free(m2);
+  free(m4);
+  free(pos);
+  free(pos0);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,21 @@
+#!/bin/bash
+# Build and run the performance benchmarks (results on stdout)
+set -e
+
+BASE="$(cd "$(dirname "$0")" && pwd)"
+cd "$BASE"
+mkdir -p bin
+
+echo "=== Compiling Benchmarks ==="
+gcc -O3 src/bench_thread_acc.c ../common/src/thread_acc.c -o bin/bench_thread_acc -pthread -lm
+gcc -O3 src/bench_output.c ../common/src/out_backend.c -o bin/bench_output
+gcc -O3 src/bench_format.c -o bin/bench_format -lm
+
+echo "=== Per-thread accumulator scaling ==="
+./bin/bench_thread_acc
+
+echo "=== Output backends (stdio / pwrite / io_uring) ==="
+./bin/bench_output
+
+echo "=== Text formatting (printf vs fast_fmt) ==="
+./bin/bench_format
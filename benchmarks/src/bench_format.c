@@ -0,0 +1,125 @@
+/**
+ * @file bench_format.c
+ * @brief Text formatting cost: snprintf vs common/fast_fmt.h
+ *
+ * Formats the three output layouts into a memory buffer (no I/O):
+ *
+ *   1d   : "%d %d %d %d\n"                 (ran_gen.dat)
+ *   2d   : "%d %ld %ld\n"                  (2d_ran_walk_trace.dat)
+ *   diff : "%ld %.12f %.12f %.12f %.12f\n" (lattice gas output)
+ *
+ * with walk-like values, checks (in an untimed pass) that both produce the
+ * same bytes and reports millions of lines per second.
+ *
+ * Usage: ./bench_format [lines]
+ */
+
+#include "../../common/include/fast_fmt.h"
+#include "../../common/include/pcg32.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BUF_BYTES (1u << 20)
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+// FNV-1a hash of the formatted bytes, used to compare the two formatters
+static void hash_bytes(uint64_t *h, const char *buf, size_t len) {
+  for (size_t k = 0; k < len; k++)
+    *h = (*h ^ (unsigned char)buf[k]) * 1099511628211ULL;
+}
+
+// Format `lines` lines of one layout; returns seconds. With hash != NULL
+// every byte is hashed too (verification pass, not meant to be timed).
+static double run(int layout, int fast, long lines, uint64_t *hash) {
+  static char buf[BUF_BYTES];
+  pcg32_random_t rng;
+  pcg32_srandom_r(&rng, 12345ULL, 67890ULL);
+  long x = 0, y = 0;
+  size_t used = 0;
+  if (hash)
+    *hash = 14695981039346656037ULL;
+  double t0 = now_seconds();
+  for (long i = 0; i < lines; i++) {
+    uint32_t r = pcg32_random_r(&rng);
+    x += (r & 1) ? 1 : -1;
+    y += (r & 2) ? 1 : -1;
+    if (used + 512 > BUF_BYTES) {
+      if (hash)
+        hash_bytes(hash, buf, used);
+      used = 0;
+    }
+    char *out = buf + used;
+    if (layout == 0) {
+      if (!fast)
+        used += (size_t)sprintf(out, "%d %d %d %d\n", (int)i, (int)x,
+                                (int)(x * x), (int)i);
+      else {
+        size_t n = fmt_i64(out, i);
+        out[n++] = ' ';
+        n += fmt_i64(out + n, x);
+        out[n++] = ' ';
+        n += fmt_i64(out + n, x * x);
+        out[n++] = ' ';
+        n += fmt_i64(out + n, i);
+        out[n++] = '\n';
+        used += n;
+      }
+    } else if (layout == 1) {
+      if (!fast)
+        used += (size_t)sprintf(out, "%d %ld %ld\n", (int)i, x, y);
+      else {
+        size_t n = fmt_i64(out, i);
+        out[n++] = ' ';
+        n += fmt_i64(out + n, x);
+        out[n++] = ' ';
+        n += fmt_i64(out + n, y);
+        out[n++] = '\n';
+        used += n;
+      }
+    } else {
+      double mean = (double)(x * x + i) / 3.0, d = mean / (4.0 * (i + 1));
+      double err = mean * 0.01, err_d = d * 0.01;
+      if (!fast)
+        used += (size_t)sprintf(out, "%ld %.12f %.12f %.12f %.12f\n", i, mean,
+                                d, err, err_d);
+      else {
+        size_t n = fmt_i64(out, i);
+        const double cols[4] = {mean, d, err, err_d};
+        for (int c = 0; c < 4; c++) {
+          out[n++] = ' ';
+          n += fmt_fixed(out + n, cols[c], 12);
+        }
+        out[n++] = '\n';
+        used += n;
+      }
+    }
+  }
+  if (hash)
+    hash_bytes(hash, buf, used);
+  return now_seconds() - t0;
+}
+
+int main(int argc, char **argv) {
+  long lines = (argc > 1) ? atol(argv[1]) : 5000000;
+  const char *names[] = {"1d", "2d", "diff"};
+  printf("# formatting %ld lines per layout\n", lines);
+  printf("# layout  printf_Ml/s  fast_Ml/s  speedup identical\n");
+  for (int layout = 0; layout < 3; layout++) {
+    uint64_t h_printf, h_fast;
+    run(layout, 0, lines, &h_printf);
+    run(layout, 1, lines, &h_fast);
+    double tp = run(layout, 0, lines, NULL);
+    double tf = run(layout, 1, lines, NULL);
+    printf("%-7s %12.2f %10.2f %8.2f %9s\n", names[layout], lines / tp / 1e6,
+           lines / tf / 1e6, tp / tf, h_printf == h_fast ? "yes" : "NO");
+  }
+  return EXIT_SUCCESS;
+}
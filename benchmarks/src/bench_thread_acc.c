@@ -0,0 +1,151 @@
+/**
+ * @file bench_thread_acc.c
+ * @brief Scaling of the per-thread accumulator layout (common/thread_acc)
+ *
+ * Runs an ensemble of 1D walks split over 1..max_threads threads, every
+ * thread accumulating exact x^2 moments at each time step, in two layouts:
+ *
+ *   padded : one cache-line aligned slab per thread (thread_acc.h), merged
+ *            by the tree reduction
+ *   shared : the same accumulators interleaved thread by thread in a single
+ *            array, so neighbouring threads write to the same cache lines
+ *
+ * Walk w always uses PCG stream w, so every run must reproduce the serial
+ * checksum exactly; the benchmark reports walks per second, speedup and
+ * parallel efficiency relative to one thread.
+ *
+ * Usage: ./bench_thread_acc [max_threads] [walks] [steps]
+ */
+
+#include "../../common/include/exact_acc.h"
+#include "../../common/include/pcg32.h"
+#include "../../common/include/thread_acc.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+  int tid, nthreads, padded;
+  long walks, steps;
+  thread_acc_t *tacc;   // padded layout
+  exact_acc_t *shared;  // interleaved layout: [t * nthreads + tid]
+} worker_t;
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static void *worker(void *arg) {
+  worker_t *w = arg;
+  exact_acc_t *acc = NULL;
+  long stride = 1;
+  if (w->padded) {
+    tacc_touch(w->tacc, w->tid);
+    acc = tacc_slab(w->tacc, w->tid);
+  } else {
+    acc = w->shared + w->tid;
+    stride = w->nthreads;
+  }
+
+  // static block distribution of walks over threads
+  long first = w->walks * w->tid / w->nthreads;
+  long last = w->walks * (w->tid + 1) / w->nthreads;
+  for (long walk = first; walk < last; walk++) {
+    pcg32_random_t rng;
+    pcg32_srandom_r(&rng, 12345ULL, (uint64_t)walk);
+    int64_t x = 0;
+    for (long t = 0; t < w->steps; t++) {
+      x += (pcg32_random_r(&rng) > 0x80000000u) ? 1 : -1;
+      exact_acc_add(&acc[t * stride], x * x);
+    }
+  }
+
+  if (w->padded)
+    tacc_reduce(w->tacc, w->tid, tacc_merge_exact_acc);
+  return NULL;
+}
+
+// Run one configuration; returns elapsed seconds, checksum in *check
+static double run(int nthreads, int padded, long walks, long steps,
+                  __int128 *check) {
+  thread_acc_t tacc;
+  exact_acc_t *shared = NULL;
+  if (padded) {
+    if (tacc_init(&tacc, nthreads, (size_t)steps, sizeof(exact_acc_t)) != 0) {
+      perror("tacc_init");
+      exit(EXIT_FAILURE);
+    }
+  } else {
+    shared = calloc((size_t)steps * nthreads, sizeof(*shared));
+    if (!shared) {
+      perror("calloc");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  pthread_t th[nthreads];
+  worker_t w[nthreads];
+  double t0 = now_seconds();
+  for (int i = 0; i < nthreads; i++) {
+    w[i] = (worker_t){i, nthreads, padded, walks, steps, &tacc, shared};
+    pthread_create(&th[i], NULL, worker, &w[i]);
+  }
+  for (int i = 0; i < nthreads; i++)
+    pthread_join(th[i], NULL);
+
+  // the shared layout still needs its (serial) reduction
+  exact_acc_t *total = padded ? tacc_slab(&tacc, 0) : shared;
+  if (!padded)
+    for (long t = 0; t < steps; t++)
+      for (int i = 1; i < nthreads; i++)
+        exact_acc_merge(&shared[t * nthreads], &shared[t * nthreads + i]);
+  double elapsed = now_seconds() - t0;
+
+  *check = 0;
+  for (long t = 0; t < steps; t++) {
+    const exact_acc_t *a = &total[padded ? t : t * nthreads];
+    *check += a->sum2 + t * a->sum;
+  }
+
+  if (padded)
+    tacc_free(&tacc);
+  free(shared);
+  return elapsed;
+}
+
+int main(int argc, char **argv) {
+  int max_threads = (argc > 1) ? atoi(argv[1])
+                               : (int)sysconf(_SC_NPROCESSORS_ONLN);
+  long walks = (argc > 2) ? atol(argv[2]) : 4096;
+  long steps = (argc > 3) ? atol(argv[3]) : 10000;
+  if (max_threads < 1 || walks < 1 || steps < 1) {
+    fprintf(stderr, "Usage: %s [max_threads] [walks] [steps]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  printf("# thread_acc scaling: %ld walks x %ld steps\n", walks, steps);
+  printf("# layout threads seconds walks_per_s speedup efficiency exact\n");
+  for (int padded = 1; padded >= 0; padded--) {
+    __int128 ref = 0;
+    double t1 = 0.0;
+    for (int n = 1; n <= max_threads; n *= 2) {
+      __int128 check;
+      double s = run(n, padded, walks, steps, &check);
+      if (n == 1) {
+        ref = check;
+        t1 = s;
+      }
+      printf("%-7s %7d %8.3f %11.0f %7.2f %10.2f %5s\n",
+             padded ? "padded" : "shared", n, s, (double)walks / s, t1 / s,
+             t1 / s / n, check == ref ? "yes" : "NO");
+      if (n < max_threads && 2 * n > max_threads)
+        n = max_threads / 2; // make sure max_threads itself is measured
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file cli_opts.h
+ * @brief Optional "key=value" command line arguments shared by the programs
+ *
+ * The simulation programs keep their historical positional arguments and
+ * accept extra settings as trailing "key=value" tokens, e.g.
+ *
+ *   ./program_diff 80 0.6 2000 100 50 out.dat target_err=0.01 max_seconds=60
+ *
+ * Lookups are linear in argc, which is irrelevant at startup.
+ */
+
+#ifndef CLI_OPTS_H
+#define CLI_OPTS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Find the value of "key=value" among argv[first..argc-1]
+ *
+ * @return Pointer to the text after '=', or NULL if the key is absent
+ */
+static inline const char *opt_value(int argc, char **argv, int first,
+                                    const char *key) {
+  size_t len = strlen(key);
+  for (int i = first; i < argc; i++)
+    if (strncmp(argv[i], key, len) == 0 && argv[i][len] == '=')
+      return argv[i] + len + 1;
+  return NULL;
+}
+
+/**
+ * @brief Check that every argv[first..argc-1] is one of the known keys
+ *
+ * @param keys NULL-terminated list of accepted keys
+ * @return 1 if all tokens are known "key=value" pairs, 0 otherwise
+ *
+ * Prints the offending token on stderr so typos do not silently fall back
+ * to default settings.
+ */
+static inline int opt_check(int argc, char **argv, int first,
+                            const char *const *keys) {
+  for (int i = first; i < argc; i++) {
+    const char *eq = strchr(argv[i], '=');
+    int known = 0;
+    for (const char *const *k = keys; eq && *k; k++)
+      if (strlen(*k) == (size_t)(eq - argv[i]) &&
+          strncmp(argv[i], *k, (size_t)(eq - argv[i])) == 0)
+        known = 1;
+    if (!known) {
+      fprintf(stderr, "Unknown option '%s'\n", argv[i]);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static inline long opt_long(int argc, char **argv, int first, const char *key,
+                            long def) {
+  const char *v = opt_value(argc, argv, first, key);
+  return v ? strtol(v, NULL, 10) : def;
+}
+
+static inline double opt_double(int argc, char **argv, int first,
+                                const char *key, double def) {
+  const char *v = opt_value(argc, argv, first, key);
+  return v ? atof(v) : def;
+}
+
+#endif // CLI_OPTS_H
@@ -0,0 +1,125 @@
+/**
+ * @file exact_acc.h
+ * @brief Exact integer accumulators for ensemble sums
+ *
+ * Every observable the walkers accumulate (x, x^2, sum of Delta r^2 over the
+ * particles of a sample) is an integer, so the ensemble sums can be kept in
+ * int64_t / __int128 instead of double. Integer addition is associative:
+ * partial accumulators coming from different runs, threads or processes can
+ * be merged in any order and the totals are bit-identical to a serial run.
+ * Conversion to floating point happens only when a mean or an error bar is
+ * requested at output time.
+ *
+ * Range: sum is int64_t, squares are __int128. The variance numerators are
+ * formed exactly in __int128, which holds as long as n * sum2 < 2^127
+ * (e.g. 1e4 runs of |x| <= 1e8 samples or x^2 <= 1e10 in 1D).
+ */
+
+#ifndef EXACT_ACC_H
+#define EXACT_ACC_H
+
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * @brief Exact first and second moments of an integer observable v
+ */
+typedef struct {
+  int64_t n;     // number of samples
+  int64_t sum;   // sum of v
+  __int128 sum2; // sum of v^2
+} exact_acc_t;
+
+/**
+ * @brief Exact moments of the ratio estimator R = sum(a_i) / sum(b_i)
+ *
+ * Used when every sample i contributes a numerator a_i over a sample-size
+ * b_i, e.g. the lattice gas where a_i = sum of Delta r^2 over the b_i
+ * particles of sample i. The cross moments give the delta-method error
+ * of R without keeping the individual samples.
+ */
+typedef struct {
+  int64_t n;       // number of samples
+  int64_t num;     // sum of a_i
+  int64_t den;     // sum of b_i
+  __int128 num2;   // sum of a_i^2
+  __int128 den2;   // sum of b_i^2
+  __int128 numden; // sum of a_i * b_i
+} exact_ratio_t;
+
+static inline void exact_acc_add(exact_acc_t *a, int64_t v) {
+  a->n++;
+  a->sum += v;
+  a->sum2 += (__int128)v * v;
+}
+
+static inline void exact_acc_merge(exact_acc_t *dst, const exact_acc_t *src) {
+  dst->n += src->n;
+  dst->sum += src->sum;
+  dst->sum2 += src->sum2;
+}
+
+static inline double exact_acc_mean(const exact_acc_t *a) {
+  return (a->n > 0) ? (double)a->sum / (double)a->n : 0.0;
+}
+
+/**
+ * @brief Unbiased sample variance (Bessel's correction, n-1)
+ */
+static inline double exact_acc_var(const exact_acc_t *a) {
+  if (a->n < 2)
+    return 0.0;
+  __int128 num = (__int128)a->n * a->sum2 - (__int128)a->sum * a->sum;
+  return (double)((long double)num /
+                  ((long double)a->n * (long double)(a->n - 1)));
+}
+
+/**
+ * @brief Standard error of the mean, sqrt(var / n)
+ */
+static inline double exact_acc_err(const exact_acc_t *a) {
+  return (a->n > 1) ? sqrt(exact_acc_var(a) / (double)a->n) : 0.0;
+}
+
+static inline void exact_ratio_add(exact_ratio_t *r, int64_t a, int64_t b) {
+  r->n++;
+  r->num += a;
+  r->den += b;
+  r->num2 += (__int128)a * a;
+  r->den2 += (__int128)b * b;
+  r->numden += (__int128)a * b;
+}
+
+static inline void exact_ratio_merge(exact_ratio_t *dst,
+                                     const exact_ratio_t *src) {
+  dst->n += src->n;
+  dst->num += src->num;
+  dst->den += src->den;
+  dst->num2 += src->num2;
+  dst->den2 += src->den2;
+  dst->numden += src->numden;
+}
+
+static inline double exact_ratio_mean(const exact_ratio_t *r) {
+  return (r->den > 0) ? (double)r->num / (double)r->den : 0.0;
+}
+
+/**
+ * @brief Delta-method standard error of R = sum(a) / sum(b)
+ *
+ * err^2 = sum_i (a_i - R b_i)^2 / (n (n-1) bbar^2), with the sum expanded
+ * into the stored moments. Reduces to the standard error of the mean of
+ * a_i / b when every b_i = b.
+ */
+static inline double exact_ratio_err(const exact_ratio_t *r) {
+  if (r->n < 2 || r->den <= 0)
+    return 0.0;
+  long double R = (long double)r->num / (long double)r->den;
+  long double ss = (long double)r->num2 - 2.0L * R * (long double)r->numden +
+                   R * R * (long double)r->den2;
+  long double bbar = (long double)r->den / (long double)r->n;
+  long double var = ss / ((long double)r->n * (long double)(r->n - 1));
+  return (var > 0.0L) ? (double)(sqrtl(var) / bbar) : 0.0;
+}
+
+#endif // EXACT_ACC_H
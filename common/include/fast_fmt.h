@@ -0,0 +1,169 @@
+/**
+ * @file fast_fmt.h
+ * @brief printf-compatible integer and fixed-point formatting into buffers
+ *
+ * The text outputs ("%d %d %d %d", "%d %ld %ld", "%ld %.12f ...") are
+ * written millions of times; going through printf means parsing the format
+ * string and locale handling for every line. These helpers write straight
+ * into the caller's buffer and return the number of bytes written (no
+ * terminating NUL):
+ *
+ *   fmt_u64 / fmt_i64 : decimal integers, two digits per step from a table,
+ *                       digit count from the bit length (no division loop
+ *                       to find the length)
+ *   fmt_fixed         : exactly what "%.<prec>f" prints. The double is
+ *                       m * 2^e, so v * 10^prec = m * 5^prec * 2^(e+prec)
+ *                       is formed exactly in 128-bit integers and rounded
+ *                       half-to-even once, like glibc does. Values whose
+ *                       scaled magnitude exceeds 128 bits, NaN and inf go
+ *                       through snprintf.
+ *
+ * Output is byte-identical to printf, so make_plots.gp and every reader of
+ * the .dat files are unaffected.
+ */
+
+#ifndef FAST_FMT_H
+#define FAST_FMT_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define FMT_MAX_PREC 17 // 5^17 * 2^53 still fits in 128 bits
+
+static const char fmt_digit_pairs[201] = "00010203040506070809"
+                                         "10111213141516171819"
+                                         "20212223242526272829"
+                                         "30313233343536373839"
+                                         "40414243444546474849"
+                                         "50515253545556575859"
+                                         "60616263646566676869"
+                                         "70717273747576777879"
+                                         "80818283848586878889"
+                                         "90919293949596979899";
+
+static const uint64_t fmt_pow10[20] = {1ULL,
+                                       10ULL,
+                                       100ULL,
+                                       1000ULL,
+                                       10000ULL,
+                                       100000ULL,
+                                       1000000ULL,
+                                       10000000ULL,
+                                       100000000ULL,
+                                       1000000000ULL,
+                                       10000000000ULL,
+                                       100000000000ULL,
+                                       1000000000000ULL,
+                                       10000000000000ULL,
+                                       100000000000000ULL,
+                                       1000000000000000ULL,
+                                       10000000000000000ULL,
+                                       100000000000000000ULL,
+                                       1000000000000000000ULL,
+                                       10000000000000000000ULL};
+
+/**
+ * @brief Number of decimal digits of v (1 for v = 0)
+ *
+ * bit length * 1233 / 4096 approximates log10(2^bits); one table compare
+ * corrects it.
+ */
+static inline int fmt_digits_u64(uint64_t v) {
+  int bits = 64 - __builtin_clzll(v | 1);
+  int d = (bits * 1233) >> 12;
+  return d + (v >= fmt_pow10[d]) + (v == 0);
+}
+
+/**
+ * @brief Write exactly ndigits digits of v (zero padded on the left)
+ */
+static inline void fmt_digits_fixed(char *out, uint64_t v, int ndigits) {
+  char *p = out + ndigits;
+  while (ndigits >= 2) {
+    unsigned pair = (unsigned)(v % 100);
+    v /= 100;
+    p -= 2;
+    memcpy(p, &fmt_digit_pairs[2 * pair], 2);
+    ndigits -= 2;
+  }
+  if (ndigits)
+    *--p = (char)('0' + v % 10);
+}
+
+static inline size_t fmt_u64(char *out, uint64_t v) {
+  int n = fmt_digits_u64(v);
+  fmt_digits_fixed(out, v, n);
+  return (size_t)n;
+}
+
+static inline size_t fmt_i64(char *out, int64_t v) {
+  // branchless sign: emit '-' always, keep it only for negative values
+  uint64_t neg = (uint64_t)v >> 63;
+  uint64_t mag = ((uint64_t)v ^ (0 - neg)) + neg;
+  out[0] = '-';
+  return neg + fmt_u64(out + neg, mag);
+}
+
+/**
+ * @brief Same bytes as snprintf(out, .., "%.<prec>f", v)
+ *
+ * @param prec 0..FMT_MAX_PREC
+ * @param out  room for at least 350 bytes in the snprintf fallback case
+ *             (any |v| < 1e18 needs fewer than 40)
+ */
+static inline size_t fmt_fixed(char *out, double v, int prec) {
+  if (!isfinite(v) || prec < 0 || prec > FMT_MAX_PREC)
+    return (size_t)snprintf(out, 350, "%.*f", prec, v);
+
+  int exp2;
+  double f = frexp(fabs(v), &exp2); // |v| = f * 2^exp2, f in [0.5, 1)
+  uint64_t m = (uint64_t)ldexp(f, 53);
+  int shift = exp2 - 53 + prec; // |v| * 10^prec = m * 5^prec * 2^shift
+
+  unsigned __int128 p = (unsigned __int128)m;
+  for (int i = 0; i < prec; i++)
+    p *= 5u;
+
+  unsigned __int128 n;
+  if (shift >= 0) {
+    if (shift > 30) // p < 2^93: larger shifts may overflow 128 bits
+      return (size_t)snprintf(out, 350, "%.*f", prec, v);
+    n = p << shift;
+  } else if (-shift >= 128) {
+    n = 0; // below half a unit in the last place: rounds to zero
+  } else {
+    int s = -shift;
+    n = p >> s;
+    unsigned __int128 rem = p - (n << s);
+    unsigned __int128 half = (unsigned __int128)1 << (s - 1);
+    if (rem > half || (rem == half && (n & 1)))
+      n++; // round half to even
+  }
+
+  uint64_t scale = fmt_pow10[prec], ip, fp;
+  if ((n >> 64) == 0) { // common case: plain 64-bit division
+    ip = (uint64_t)n / scale;
+    fp = (uint64_t)n - ip * scale;
+  } else {
+    unsigned __int128 ip128 = n / scale;
+    if (ip128 >> 64) // integer part beyond 64 bits: leave it to printf
+      return (size_t)snprintf(out, 350, "%.*f", prec, v);
+    ip = (uint64_t)ip128;
+    fp = (uint64_t)(n - ip128 * scale);
+  }
+
+  size_t len = 0;
+  if (signbit(v))
+    out[len++] = '-'; // printf keeps the sign of -0.0 and tiny negatives
+  len += fmt_u64(out + len, ip);
+  if (prec > 0) {
+    out[len++] = '.';
+    fmt_digits_fixed(out + len, fp, prec);
+    len += (size_t)prec;
+  }
+  return len;
+}
+
+#endif // FAST_FMT_H
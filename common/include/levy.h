@@ -0,0 +1,171 @@
+/**
+ * @file levy.h
+ * @brief Lattice Levy flights: batched jump lengths and tail-safe statistics
+ *
+ * Jumps have integer Pareto lengths, P(L >= l) = l^-alpha (l >= 1), drawn by
+ * inverse CDF, L = floor(u^(-1/alpha)), from one 32-bit draw: bits 2..31
+ * give u in (0, 1], bits 0..1 are left to the caller for the direction.
+ * With u = m 2^-e and m in [1/2, 1), u^(-1/alpha) is a power-of-two table
+ * entry times a mantissa table entry (linear interpolation), so a length
+ * costs a clz, two loads and a multiply. levy_fill() maps a whole batch of
+ * draws at once: the generator fills the batch first, then the mapping
+ * runs over independent elements and the walk consumes the lengths.
+ *
+ * For alpha < 2 the second moment of the position diverges; the statistics
+ * kept instead are the mean of ln(1 + |x|) (fixed point, exact_acc_t, so
+ * sums merge bit-identically across threads) and a histogram of
+ * log2(1 + |x|) in LEVY_BINS_PER_OCTAVE bins per octave, from which the
+ * quantiles of |x| are read. Both scale with t^(1/alpha).
+ *
+ * alpha is restricted to [LEVY_ALPHA_MIN, 2]: lengths stay below 2^60 and
+ * positions of 64-bit walkers cannot overflow in any feasible run.
+ */
+
+#ifndef LEVY_H
+#define LEVY_H
+
+#include "exact_acc.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LEVY_ALPHA_MIN 0.5
+#define LEVY_BATCH 256            // draws per batch
+#define LEVY_MANT_BITS 10         // mantissa table of 2^10 + 1 entries
+#define LEVY_BINS_PER_OCTAVE 16   // log2(1 + |x|) histogram resolution
+#define LEVY_BINS (64 * LEVY_BINS_PER_OCTAVE)
+#define LEVY_LOG_SCALE 16777216.0 // fixed point of ln(1 + |x|): 2^24
+#define LEVY_POINTS_PER_DECADE 20 // output times
+
+typedef struct {
+  double alpha;
+  double pow2[31];                        // 2^((e - 1) / alpha)
+  double mant[(1 << LEVY_MANT_BITS) + 1]; // (m / 2^32)^(-1/alpha)
+} levy_table_t;
+
+/**
+ * @brief Online statistics of |x| at one output time
+ */
+typedef struct {
+  exact_acc_t logd;        // ln(1 + |x|) * LEVY_LOG_SCALE
+  int64_t hist[LEVY_BINS]; // counts per bin of log2(1 + |x|)
+} levy_stats_t;
+
+/**
+ * @return 0 on success, -1 if alpha is outside [LEVY_ALPHA_MIN, 2]
+ */
+static inline int levy_table_init(levy_table_t *t, double alpha) {
+  if (!(alpha >= LEVY_ALPHA_MIN && alpha <= 2.0))
+    return -1;
+  t->alpha = alpha;
+  for (int e = 0; e <= 30; e++)
+    t->pow2[e] = pow(2.0, (e - 1) / alpha);
+  for (int k = 0; k <= (1 << LEVY_MANT_BITS); k++)
+    t->mant[k] = pow(0.5 + 0.5 * k / (1 << LEVY_MANT_BITS), -1.0 / alpha);
+  return 0;
+}
+
+/**
+ * @brief Jump length >= 1 from the top 30 bits of r
+ */
+static inline int64_t levy_length(const levy_table_t *t, uint32_t r) {
+  uint32_t v = (r >> 2) + 1;    // u = v / 2^30 in (0, 1]
+  int e = __builtin_clz(v) - 1; // 0 .. 30, u = (m / 2^32) 2^(1 - e)
+  uint32_t m = v << (e + 1);    // mantissa in [2^31, 2^32)
+  const int shift = 31 - LEVY_MANT_BITS;
+  uint32_t k = (m >> shift) & ((1u << LEVY_MANT_BITS) - 1);
+  double frac = (double)(m & ((1u << shift) - 1)) / (double)(1u << shift);
+  double l = t->pow2[e] * (t->mant[k] + frac * (t->mant[k + 1] - t->mant[k]));
+  return l < 1.0 ? 1 : (int64_t)l;
+}
+
+/**
+ * @brief Lengths of a batch of draws: len[i] from r[i]
+ */
+static inline void levy_fill(const levy_table_t *t, const uint32_t *r,
+                             int64_t *len, int n) {
+  for (int i = 0; i < n; i++)
+    len[i] = levy_length(t, r[i]);
+}
+
+static inline void levy_stats_add(levy_stats_t *s, double dist) {
+  exact_acc_add(&s->logd, llround(log1p(dist) * LEVY_LOG_SCALE));
+  int b = (int)(log2(1.0 + dist) * LEVY_BINS_PER_OCTAVE);
+  s->hist[b < LEVY_BINS ? b : LEVY_BINS - 1]++;
+}
+
+/**
+ * @brief tacc_merge_fn for arrays of levy_stats_t
+ */
+static inline void levy_stats_merge(void *dst, const void *src, size_t n) {
+  levy_stats_t *d = dst;
+  const levy_stats_t *s = src;
+  for (size_t i = 0; i < n; i++) {
+    exact_acc_merge(&d[i].logd, &s[i].logd);
+    for (int b = 0; b < LEVY_BINS; b++)
+      d[i].hist[b] += s[i].hist[b];
+  }
+}
+
+/**
+ * @brief q-quantile of |x|, interpolated in log2(1 + |x|) inside its bin
+ */
+static inline double levy_quantile(const levy_stats_t *s, double q) {
+  double want = q * (double)s->logd.n, cum = 0.0;
+  for (int b = 0; b < LEVY_BINS; b++) {
+    if (s->hist[b] > 0 && cum + (double)s->hist[b] >= want) {
+      double f = (want - cum) / (double)s->hist[b];
+      return exp2((b + f) / LEVY_BINS_PER_OCTAVE) - 1.0;
+    }
+    cum += (double)s->hist[b];
+  }
+  return 0.0;
+}
+
+/**
+ * @brief Log-spaced output times 1 <= t <= max_t (malloc'ed, ascending)
+ *
+ * The caller checks max_t >= 1.
+ * @return number of times, -1 if out of memory
+ */
+static inline int levy_times(long max_t, long **times) {
+  int cap = LEVY_POINTS_PER_DECADE * (int)ceil(log10((double)max_t) + 1) + 1;
+  int n = 0;
+  if (!(*times = malloc((size_t)cap * sizeof(**times))))
+    return -1;
+  for (int i = 0; n < cap; i++) {
+    long t = lround(pow(10.0, (double)i / LEVY_POINTS_PER_DECADE));
+    if (t > max_t)
+      break;
+    if (n == 0 || t > (*times)[n - 1])
+      (*times)[n++] = t;
+  }
+  return n;
+}
+
+/**
+ * @brief Write "t <ln(1+|x|)> err q25 q50 q75 q90 t^(1/alpha)"
+ */
+static inline int levy_write(const char *path, const char *what,
+                             const long *times, const levy_stats_t *s, int n,
+                             double alpha) {
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return -1;
+  fprintf(f, "# Levy flight alpha = %g, %s\n", alpha, what);
+  fprintf(f, "# t <ln(1+d)> err q25(d) q50(d) q75(d) q90(d) t^(1/alpha)\n");
+  for (int i = 0; i < n; i++) {
+    if (s[i].logd.n == 0)
+      continue;
+    fprintf(f, "%ld %.6f %.6f %.6g %.6g %.6g %.6g %.6g\n", times[i],
+            exact_acc_mean(&s[i].logd) / LEVY_LOG_SCALE,
+            exact_acc_err(&s[i].logd) / LEVY_LOG_SCALE,
+            levy_quantile(&s[i], 0.25), levy_quantile(&s[i], 0.5),
+            levy_quantile(&s[i], 0.75), levy_quantile(&s[i], 0.9),
+            pow((double)times[i], 1.0 / alpha));
+  }
+  return fclose(f) == 0 ? 0 : -1;
+}
+
+#endif // LEVY_H
@@ -0,0 +1,70 @@
+/**
+ * @file out_backend.h
+ * @brief Buffered output files with stdio, pwrite or io_uring backends
+ *
+ * The writer thread formats text into large buffers and hands each full
+ * buffer to an ob_file_t. Every file owns two buffers (double buffering):
+ *
+ *   stdio  : fwrite of the buffer (the historical path)
+ *   pwrite : pwrite(2) at an explicit file offset, no stdio copy
+ *   uring  : Linux io_uring with both buffers registered once
+ *            (IORING_OP_WRITE_FIXED); the write of one buffer proceeds in the
+ *            kernel while the caller fills the other one
+ *
+ * The backend is chosen at run time with the MCRW_OUTPUT environment
+ * variable ("stdio", "pwrite" or "uring"; default stdio). If io_uring is
+ * unavailable (old kernel, seccomp, not Linux) the file falls back to
+ * pwrite, so requesting it is always safe.
+ */
+
+#ifndef OUT_BACKEND_H
+#define OUT_BACKEND_H
+
+#include <stddef.h>
+
+typedef enum { OB_STDIO = 0, OB_PWRITE, OB_URING } ob_backend_t;
+
+typedef struct ob_file ob_file_t;
+
+/**
+ * @brief Backend requested through MCRW_OUTPUT (OB_STDIO if unset/unknown)
+ */
+ob_backend_t ob_backend_from_env(void);
+
+/**
+ * @brief Open path for writing
+ *
+ * @param mode      "w" (truncate) or "a" (append)
+ * @param buf_bytes capacity of each of the two buffers
+ * @return NULL on failure (errno set)
+ */
+ob_file_t *ob_open(const char *path, const char *mode, ob_backend_t backend,
+                   size_t buf_bytes);
+
+/**
+ * @brief Buffer the caller may fill next (buf_bytes capacity)
+ *
+ * Valid until the next ob_submit(); never aliases a buffer still in flight.
+ */
+char *ob_buf(ob_file_t *f);
+
+/**
+ * @brief Queue the first len bytes of the current buffer for writing
+ *
+ * @return 0 on success, -1 if this or an earlier asynchronous write failed
+ */
+int ob_submit(ob_file_t *f, size_t len);
+
+/**
+ * @brief Wait for pending writes, close and free
+ *
+ * @return 0 on success, -1 if any write or the close failed
+ */
+int ob_close(ob_file_t *f);
+
+/**
+ * @brief Backend actually in use ("stdio", "pwrite" or "uring")
+ */
+const char *ob_backend_name(const ob_file_t *f);
+
+#endif // OUT_BACKEND_H
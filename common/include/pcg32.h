@@ -0,0 +1,82 @@
+/*============================================================================
+ * PCG32 RANDOM NUMBER GENERATOR (reentrant, header only)
+ *
+ * Minimal implementation of PCG32 (Permuted Congruential Generator)
+ * Licensed under Apache License 2.0 - (c) 2014 M.E. O'Neill
+ * Website: https://www.pcg-random.org/
+ *
+ * Same generator as the per-program copies, but every function takes its
+ * state explicitly and is inlined, so multi-stream code (one stream per
+ * walker or per thread) pays no call overhead in the step loops.
+ *===========================================================================*/
+
+#ifndef COMMON_PCG32_H
+#define COMMON_PCG32_H
+
+#include <stdint.h>
+
+/**
+ * @brief PCG32 random number generator state structure
+ *
+ * - state: The main RNG state (64-bit)
+ * - inc: The stream selector (must be odd, determines the sequence)
+ */
+typedef struct {
+  uint64_t state; // Current state of the generator
+  uint64_t inc;   // Increment (stream identifier), always odd
+} pcg32_random_t;
+
+#define PCG32_MULT 6364136223846793005ULL
+
+/**
+ * @brief Generate next 32-bit random number (XSH-RR output)
+ */
+static inline uint32_t pcg32_random_r(pcg32_random_t *rng) {
+  uint64_t oldstate = rng->state;
+  rng->state = oldstate * PCG32_MULT + (rng->inc | 1);
+  uint32_t xorshifted = (uint32_t)(((oldstate >> 18u) ^ oldstate) >> 27u);
+  uint32_t rot = (uint32_t)(oldstate >> 59u);
+  return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+/**
+ * @brief Seed a generator; initseq selects one of 2^63 streams
+ */
+static inline void pcg32_srandom_r(pcg32_random_t *rng, uint64_t initstate,
+                                   uint64_t initseq) {
+  rng->state = 0U;
+  rng->inc = (initseq << 1u) | 1u; // Ensure increment is odd
+  pcg32_random_r(rng);             // Warm-up step
+  rng->state += initstate;
+  pcg32_random_r(rng); // Second warm-up step
+}
+
+/**
+ * @brief Jump the generator delta steps ahead in O(log delta)
+ *
+ * Brown's "Random number generation with arbitrary strides": composes the
+ * affine LCG map with itself by repeated squaring.
+ */
+static inline void pcg32_advance_r(pcg32_random_t *rng, uint64_t delta) {
+  uint64_t cur_mult = PCG32_MULT, cur_plus = rng->inc | 1;
+  uint64_t acc_mult = 1u, acc_plus = 0u;
+  while (delta > 0) {
+    if (delta & 1) {
+      acc_mult *= cur_mult;
+      acc_plus = acc_plus * cur_mult + cur_plus;
+    }
+    cur_plus = (cur_mult + 1) * cur_plus;
+    cur_mult *= cur_mult;
+    delta /= 2;
+  }
+  rng->state = acc_mult * rng->state + acc_plus;
+}
+
+/**
+ * @brief Uniform double in [0, 1) (same conversion as myrand())
+ */
+static inline double pcg32_double_r(pcg32_random_t *rng) {
+  return (double)pcg32_random_r(rng) / ((double)UINT32_MAX + 1.0);
+}
+
+#endif // COMMON_PCG32_H
@@ -0,0 +1,89 @@
+/**
+ * @file rec_writer.h
+ * @brief Dedicated writer thread draining per-producer SPSC rings
+ *
+ * The simulation loops no longer call fprintf: every producer (simulation
+ * thread) pushes small binary records into its own spsc_ring_t, and one
+ * writer thread formats them into large per-file buffers and does the I/O.
+ *
+ * Typical use:
+ *
+ *   rec_writer_t *w = rw_create(1, RW_DEFAULT_RING);
+ *   int traj = rw_add_sink(w, "traj.dat", "w", fmt_traj, NULL);
+ *   rw_start(w);
+ *   spsc_ring_t *ring = rw_producer_ring(w, 0);
+ *   ... rw_push(ring, traj, t, x, y); ...
+ *   rw_producer_done(w, 0);
+ *   rw_finish(w);
+ *
+ * Records of one producer reach each file in push order. The file backend
+ * (stdio, pwrite or io_uring) is selected with MCRW_OUTPUT, see
+ * out_backend.h.
+ */
+
+#ifndef REC_WRITER_H
+#define REC_WRITER_H
+
+#include "spsc_ring.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define RW_DEFAULT_RING (1u << 16) // records per producer ring
+#define RW_MAX_LINE 256            // longest line a format function may emit
+
+/**
+ * @brief Format one record as text into out (at most RW_MAX_LINE bytes)
+ *
+ * @return Number of bytes written
+ */
+typedef size_t (*rw_format_fn)(char *out, const spsc_record_t *rec,
+                               const void *ctx);
+
+typedef struct rec_writer rec_writer_t;
+
+/**
+ * @brief Create a writer with one ring per producer (not yet running)
+ *
+ * @return NULL on allocation failure
+ */
+rec_writer_t *rw_create(int nproducers, size_t ring_records);
+
+/**
+ * @brief Open an output file; call before rw_start()
+ *
+ * @param mode fopen-style "w" (truncate) or "a" (append)
+ * @param ctx  passed unchanged to fmt (e.g. constant columns)
+ * @return Sink id for rw_push(), or -1 if the file cannot be opened
+ */
+int rw_add_sink(rec_writer_t *w, const char *path, const char *mode,
+                rw_format_fn fmt, const void *ctx);
+
+/**
+ * @brief Launch the writer thread
+ *
+ * @return 0 on success, -1 if the thread cannot be created
+ */
+int rw_start(rec_writer_t *w);
+
+spsc_ring_t *rw_producer_ring(rec_writer_t *w, int producer);
+
+/**
+ * @brief Signal that a producer will push no more records
+ */
+void rw_producer_done(rec_writer_t *w, int producer);
+
+/**
+ * @brief Wait for all producers to finish, drain, close files, free
+ *
+ * Producers that did not call rw_producer_done() are marked done.
+ * @return 0 on success, -1 if any write or close failed
+ */
+int rw_finish(rec_writer_t *w);
+
+static inline void rw_push(spsc_ring_t *ring, int sink, int64_t a, int64_t b,
+                           int64_t c) {
+  spsc_record_t rec = {sink, 0, {a, b, c}};
+  spsc_push(ring, &rec);
+}
+
+#endif // REC_WRITER_H
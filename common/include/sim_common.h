@@ -0,0 +1,29 @@
+/**
+ * @file sim_common.h
+ * @brief Seeding constants, path length and wall-clock timing of the programs
+ *
+ * Every program seeds its generators from the same (state, sequence) pair,
+ * so results are reproducible and comparable between programs and with
+ * libmcrw (MCRW_SEED_DEFAULT is defined from these constants). The programs
+ * that report their throughput time the simulation with sim_clock().
+ */
+
+#ifndef SIM_COMMON_H
+#define SIM_COMMON_H
+
+#include <time.h>
+
+#define SIM_SEED_STATE 12345ULL
+#define SIM_SEED_SEQ 67890ULL
+#define SIM_PATH_LENGTH 256 // output file names built from a prefix
+
+/**
+ * @brief Monotonic wall-clock time in seconds (differences only)
+ */
+static inline double sim_clock(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + 1e-9 * (double)t.tv_nsec;
+}
+
+#endif // SIM_COMMON_H
@@ -0,0 +1,115 @@
+/**
+ * @file spsc_ring.h
+ * @brief Lock-free single-producer/single-consumer ring of binary records
+ *
+ * One ring per simulation thread carries fixed-size output records to the
+ * writer thread (rec_writer.h). Head and tail live on separate cache lines
+ * and each side keeps a cached copy of the other side's index, so in the
+ * common case a push or a pop touches no shared line at all; the indices
+ * are published with release stores and read with acquire loads.
+ *
+ * Capacity is a power of two; indices run freely and are masked on access.
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief One output record: destination sink plus three integer fields
+ *
+ * The meaning of v[] is up to the sink's format function (e.g. time, x, y).
+ */
+typedef struct {
+  int32_t sink;
+  int32_t pad;
+  int64_t v[3];
+} spsc_record_t;
+
+typedef struct {
+  _Alignas(64) _Atomic size_t head; // next slot to fill (producer)
+  size_t cached_tail;               // producer's last view of tail
+  _Alignas(64) _Atomic size_t tail; // next slot to drain (consumer)
+  size_t cached_head;               // consumer's last view of head
+  _Alignas(64) size_t mask;         // capacity - 1 (read-only)
+  spsc_record_t *slots;
+} spsc_ring_t;
+
+/**
+ * @brief Allocate a ring of at least min_records slots (rounded to 2^k)
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+static inline int spsc_init(spsc_ring_t *r, size_t min_records) {
+  size_t cap = 64;
+  while (cap < min_records)
+    cap *= 2;
+  r->slots = aligned_alloc(64, cap * sizeof(spsc_record_t));
+  if (!r->slots)
+    return -1;
+  atomic_init(&r->head, 0);
+  atomic_init(&r->tail, 0);
+  r->cached_tail = r->cached_head = 0;
+  r->mask = cap - 1;
+  return 0;
+}
+
+static inline void spsc_free(spsc_ring_t *r) {
+  free(r->slots);
+  r->slots = NULL;
+}
+
+/**
+ * @brief Producer side: append a record, or return 0 if the ring is full
+ */
+static inline int spsc_try_push(spsc_ring_t *r, const spsc_record_t *rec) {
+  size_t h = atomic_load_explicit(&r->head, memory_order_relaxed);
+  if (h - r->cached_tail > r->mask) {
+    r->cached_tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (h - r->cached_tail > r->mask)
+      return 0;
+  }
+  r->slots[h & r->mask] = *rec;
+  atomic_store_explicit(&r->head, h + 1, memory_order_release);
+  return 1;
+}
+
+/**
+ * @brief Producer side: append a record, yielding while the ring is full
+ *
+ * With rings of ~1e5 records the producer only waits when the writer is
+ * persistently slower than the simulation (disk bound), which is the
+ * back-pressure we want instead of unbounded memory growth.
+ */
+static inline void spsc_push(spsc_ring_t *r, const spsc_record_t *rec) {
+  while (!spsc_try_push(r, rec))
+    sched_yield();
+}
+
+/**
+ * @brief Consumer side: number of records ready, and a pointer to the first
+ *
+ * At most the contiguous part up to the end of the slot array is returned;
+ * call spsc_release() after processing them.
+ */
+static inline size_t spsc_peek(spsc_ring_t *r, const spsc_record_t **first) {
+  size_t t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+  if (r->cached_head == t)
+    r->cached_head = atomic_load_explicit(&r->head, memory_order_acquire);
+  size_t n = r->cached_head - t;
+  size_t to_end = r->mask + 1 - (t & r->mask);
+  *first = &r->slots[t & r->mask];
+  return n < to_end ? n : to_end;
+}
+
+static inline void spsc_release(spsc_ring_t *r, size_t n) {
+  size_t t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+  atomic_store_explicit(&r->tail, t + n, memory_order_release);
+}
+
+#endif // SPSC_RING_H
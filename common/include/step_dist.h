@@ -0,0 +1,186 @@
+/**
+ * @file step_dist.h
+ * @brief Finite step distributions sampled in O(1) by alias tables
+ *
+ * A step set {(dx_i, dy_i)} with weights w_i (biased, next-nearest
+ * neighbour, king moves, ...) is turned into a Walker/Vose alias table: n
+ * columns of height 1/n, column i keeps step i with probability prob_i and
+ * gives the rest to step alias_i. One 32-bit draw r picks both: the high
+ * word of r * n is the column, the low word (uniform on a grid of spacing
+ * n / 2^32) is compared with the integer threshold prob_i * 2^32. Sampling
+ * is a multiply, one table load and a compare whatever the distribution.
+ *
+ * Specifications (step_dist_parse):
+ * - "nn":   the nearest-neighbour steps, equal weights (1D: +-1)
+ * - "diag": the four diagonal steps (2D)
+ * - "king": nearest neighbours and diagonals, equal weights (2D)
+ * - a list "dx:w,dx:w,..." (1D) or "dx:dy:w,dx:dy:w,..." (2D) of steps and
+ *   non-negative weights, e.g. "1:0:2,-1:0:1,0:1:1,0:-1:1" for a drift +x
+ */
+
+#ifndef STEP_DIST_H
+#define STEP_DIST_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STEP_MAX 32              // steps in one distribution
+#define STEP_DIST_MAX_JUMP 1000000 // largest |dx|, |dy| of a step
+
+typedef struct {
+  int n, dim;
+  int dx[STEP_MAX], dy[STEP_MAX];
+  double p[STEP_MAX];      // normalized probabilities
+  uint64_t prob[STEP_MAX]; // keep threshold, probability * 2^32
+  uint8_t alias[STEP_MAX]; // step taken when the column rejects
+} step_dist_t;
+
+/**
+ * @brief Vose's construction from the weights in d->p (normalized here)
+ *
+ * @return 0 on success, -1 if the weights are negative or all zero
+ */
+static inline int step_dist_build(step_dist_t *d) {
+  double sum = 0.0, q[STEP_MAX];
+  int small[STEP_MAX], large[STEP_MAX], ns = 0, nl = 0;
+  for (int i = 0; i < d->n; i++) {
+    if (!(d->p[i] >= 0.0))
+      return -1;
+    sum += d->p[i];
+  }
+  if (!(sum > 0.0))
+    return -1;
+  for (int i = 0; i < d->n; i++) {
+    d->p[i] /= sum;
+    q[i] = d->p[i] * d->n; // column heights in units of 1/n
+    if (q[i] < 1.0)
+      small[ns++] = i;
+    else
+      large[nl++] = i;
+  }
+  while (ns > 0 && nl > 0) {
+    int s = small[--ns], l = large[nl - 1];
+    d->prob[s] = (uint64_t)(q[s] * 4294967296.0);
+    d->alias[s] = (uint8_t)l;
+    q[l] -= 1.0 - q[s]; // l fills the rest of column s
+    if (q[l] < 1.0) {
+      nl--;
+      small[ns++] = l;
+    }
+  }
+  // leftovers are full columns (up to rounding)
+  while (nl > 0) {
+    int l = large[--nl];
+    d->prob[l] = 1ULL << 32;
+    d->alias[l] = (uint8_t)l;
+  }
+  while (ns > 0) {
+    int s = small[--ns];
+    d->prob[s] = 1ULL << 32;
+    d->alias[s] = (uint8_t)s;
+  }
+  return 0;
+}
+
+/**
+ * @brief Parse a specification (see the file comment) for dim 1 or 2
+ *
+ * @return 0 on success, -1 on a malformed or empty specification, or a
+ *         step with |dx| or |dy| above STEP_DIST_MAX_JUMP
+ */
+static inline int step_dist_parse(step_dist_t *d, int dim, const char *spec) {
+  static const int nn[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+  static const int dg[4][2] = {{1, 1}, {-1, 1}, {-1, -1}, {1, -1}};
+  memset(d, 0, sizeof(*d));
+  d->dim = dim;
+  if (strcmp(spec, "nn") == 0 || (dim == 2 && (strcmp(spec, "diag") == 0 ||
+                                               strcmp(spec, "king") == 0))) {
+    int with_nn = spec[0] != 'd', with_dg = spec[0] != 'n';
+    for (int i = 0; i < 4 && with_nn; i++) {
+      if (dim == 1 && i >= 2)
+        break;
+      d->dx[d->n] = nn[i][0];
+      d->dy[d->n] = nn[i][1];
+      d->p[d->n++] = 1.0;
+    }
+    for (int i = 0; i < 4 && with_dg; i++) {
+      d->dx[d->n] = dg[i][0];
+      d->dy[d->n] = dg[i][1];
+      d->p[d->n++] = 1.0;
+    }
+    return step_dist_build(d);
+  }
+
+  const char *c = spec;
+  while (*c != '\0') {
+    char *end;
+    long v[3];
+    int k;
+    for (k = 0; k <= dim; k++) {
+      if (k < dim)
+        v[k] = strtol(c, &end, 10);
+      else
+        d->p[d->n] = strtod(c, &end);
+      if (end == c || (k < dim && *end != ':'))
+        return -1;
+      c = (k < dim) ? end + 1 : end;
+    }
+    if (d->n == STEP_MAX)
+      return -1;
+    for (k = 0; k < dim; k++) // also rejects strtol's LONG_MIN/MAX overflow
+      if (v[k] < -STEP_DIST_MAX_JUMP || v[k] > STEP_DIST_MAX_JUMP)
+        return -1;
+    d->dx[d->n] = (int)v[0];
+    d->dy[d->n] = (dim == 2) ? (int)v[1] : 0;
+    d->n++;
+    if (*c == ',')
+      c++;
+    else if (*c != '\0')
+      return -1;
+  }
+  return (d->n > 0) ? step_dist_build(d) : -1;
+}
+
+/**
+ * @brief Index of the step drawn with the 32 random bits r
+ */
+static inline int step_dist_sample(const step_dist_t *d, uint32_t r) {
+  uint64_t m = (uint64_t)r * (uint64_t)d->n;
+  int i = (int)(m >> 32);
+  return ((uint32_t)m < d->prob[i]) ? i : d->alias[i];
+}
+
+/**
+ * @brief Largest |dx| or |dy| of the steps: |x| <= t * max after t steps
+ */
+static inline long step_dist_max_jump(const step_dist_t *d) {
+  long m = 0;
+  for (int i = 0; i < d->n; i++) {
+    m = labs(d->dx[i]) > m ? labs(d->dx[i]) : m;
+    m = labs(d->dy[i]) > m ? labs(d->dy[i]) : m;
+  }
+  return m;
+}
+
+/**
+ * @brief Mean step <dx> (axis 0) or <dy> (axis 1)
+ */
+static inline double step_dist_mean(const step_dist_t *d, int axis) {
+  double m = 0.0;
+  for (int i = 0; i < d->n; i++)
+    m += d->p[i] * (axis ? d->dy[i] : d->dx[i]);
+  return m;
+}
+
+/**
+ * @brief Mean squared step length <dx^2 + dy^2>
+ */
+static inline double step_dist_msd(const step_dist_t *d) {
+  double m = 0.0;
+  for (int i = 0; i < d->n; i++)
+    m += d->p[i] * ((double)d->dx[i] * d->dx[i] + (double)d->dy[i] * d->dy[i]);
+  return m;
+}
+
+#endif // STEP_DIST_H
@@ -0,0 +1,82 @@
+/**
+ * @file thread_acc.h
+ * @brief Per-thread accumulator slabs without false sharing
+ *
+ * Parallel versions of the ensemble accumulators (sum[t] of the 1D walk, the
+ * position histograms of the 2D walk, the Delta r^2 sums of the lattice gas)
+ * give every thread a private copy of the whole accumulator array:
+ *
+ *   - each slab starts on a cache line (a page for slabs >= 4 KiB) and is
+ *     padded to a whole number of them, so no two threads ever write to the
+ *     same line;
+ *   - the memory is mapped but untouched at allocation, and every thread
+ *     zeroes its own slab with tacc_touch(): on NUMA machines the first-touch
+ *     policy then places the pages on the node of the thread that uses them;
+ *   - at the end the slabs are combined by a binary tree reduction run by the
+ *     threads themselves (log2(nthreads) levels separated by a barrier); the
+ *     total ends up in slab 0.
+ *
+ * Element types are opaque: the caller supplies the merge function. Merges
+ * of exact_acc.h accumulators or integer counts are associative, so the tree
+ * gives the same bits as a serial run.
+ */
+
+#ifndef THREAD_ACC_H
+#define THREAD_ACC_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+#define TACC_CACHE_LINE 64
+#define TACC_PAGE 4096
+
+/**
+ * @brief Merge nelem elements of src into dst (dst += src)
+ */
+typedef void (*tacc_merge_fn)(void *dst, const void *src, size_t nelem);
+
+typedef struct {
+  int nthreads;
+  size_t nelem;      // elements per slab
+  size_t elem_size;  // bytes per element
+  size_t slab_bytes; // padded slab stride
+  size_t map_bytes;  // size of the mapping
+  unsigned char *base;
+  pthread_barrier_t barrier;
+} thread_acc_t;
+
+/**
+ * @brief Reserve nthreads slabs of nelem elements (pages not yet touched)
+ *
+ * @return 0 on success, -1 if the mapping or the barrier cannot be created
+ */
+int tacc_init(thread_acc_t *a, int nthreads, size_t nelem, size_t elem_size);
+
+/**
+ * @brief Zero the slab of thread tid; call it from thread tid (first touch)
+ */
+void tacc_touch(thread_acc_t *a, int tid);
+
+/**
+ * @brief Collective tree reduction: every thread 0..nthreads-1 must call it
+ *
+ * Returns once slab 0 holds the merged total. The other slabs are left in an
+ * unspecified (partially merged) state.
+ */
+void tacc_reduce(thread_acc_t *a, int tid, tacc_merge_fn merge);
+
+/**
+ * @brief Release the slabs; no-op on a zeroed or failed (tacc_init) one
+ */
+void tacc_free(thread_acc_t *a);
+
+static inline void *tacc_slab(const thread_acc_t *a, int tid) {
+  return a->base + (size_t)tid * a->slab_bytes;
+}
+
+/* merge functions for the element types used by the simulations */
+void tacc_merge_i64(void *dst, const void *src, size_t nelem);
+void tacc_merge_exact_acc(void *dst, const void *src, size_t nelem);
+void tacc_merge_exact_ratio(void *dst, const void *src, size_t nelem);
+
+#endif // THREAD_ACC_H
@@ -0,0 +1,51 @@
+/**
+ * @file torus.h
+ * @brief Periodic neighbour tables of an L x L torus
+ *
+ * The lattice gas (03) and the cover-time walks of program_2d move on the
+ * same periodic square lattice. Both axes have length L, so one pair of
+ * tables serves x and y: plus[i] = (i + 1) mod L, minus[i] = (i - 1) mod L.
+ * Table lookups replace the modulo in the step loops.
+ */
+
+#ifndef TORUS_H
+#define TORUS_H
+
+#include <stdlib.h>
+
+typedef struct {
+  long L;
+  long *plus, *minus;
+} torus_t;
+
+/**
+ * @brief Allocate and fill the tables
+ *
+ * @return 0 on success, -1 if L < 1 or memory is short
+ */
+static inline int torus_init(torus_t *t, long L) {
+  t->L = L;
+  t->plus = (L > 0) ? malloc((size_t)L * sizeof(*t->plus)) : NULL;
+  t->minus = (L > 0) ? malloc((size_t)L * sizeof(*t->minus)) : NULL;
+  if (!t->plus || !t->minus) {
+    free(t->plus);
+    free(t->minus);
+    t->plus = t->minus = NULL;
+    return -1;
+  }
+  for (long i = 0; i < L; i++) {
+    t->plus[i] = i + 1;
+    t->minus[i] = i - 1;
+  }
+  t->plus[L - 1] = 0;
+  t->minus[0] = L - 1;
+  return 0;
+}
+
+static inline void torus_free(torus_t *t) {
+  free(t->plus);
+  free(t->minus);
+  t->plus = t->minus = NULL;
+}
+
+#endif // TORUS_H
@@ -0,0 +1,355 @@
+/**
+ * @file out_backend.c
+ * @brief stdio / pwrite / io_uring implementations of ob_file_t
+ *
+ * The io_uring path talks to the kernel through the raw system calls and
+ * the <linux/io_uring.h> ABI, so no liburing is needed at build time.
+ */
+
+#include "../include/out_backend.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+#define OB_ALIGN 4096
+
+#ifdef __linux__
+// Shared-memory view of one io_uring instance (submission depth 2)
+typedef struct {
+  int fd;
+  unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  void *sq_map, *cq_map;
+  size_t sq_map_bytes, cq_map_bytes, sqes_bytes;
+} ob_uring_t;
+#endif
+
+struct ob_file {
+  ob_backend_t backend;
+  int fd;
+  FILE *fp;
+  off_t offset;     // next file offset (pwrite / uring)
+  char *buf[2];     // double buffer
+  size_t buf_bytes; // capacity of each buffer
+  int cur;          // buffer being filled by the caller
+  int in_flight[2]; // uring: write of buf[i] not yet completed
+  size_t pending_len[2];
+  off_t pending_off[2];
+  char *spare;      // uring: replaces a buffer whose write cannot be reaped
+  char *retired[2]; // uring: such buffers, kept until the ring is gone
+  int error;
+#ifdef __linux__
+  ob_uring_t ring;
+#endif
+};
+
+ob_backend_t ob_backend_from_env(void) {
+  const char *v = getenv("MCRW_OUTPUT");
+  if (v && strcmp(v, "pwrite") == 0)
+    return OB_PWRITE;
+  if (v && strcmp(v, "uring") == 0)
+    return OB_URING;
+  return OB_STDIO;
+}
+
+const char *ob_backend_name(const ob_file_t *f) {
+  static const char *const names[] = {"stdio", "pwrite", "uring"};
+  return names[f->backend];
+}
+
+// Write all of buf at off, retrying on short writes
+static int pwrite_all(int fd, const char *buf, size_t len, off_t off) {
+  while (len > 0) {
+    ssize_t w = pwrite(fd, buf, len, off);
+    if (w < 0) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    buf += w;
+    len -= (size_t)w;
+    off += w;
+  }
+  return 0;
+}
+
+/*============================================================================
+ * IO_URING
+ *===========================================================================*/
+#ifdef __linux__
+
+static int uring_setup(ob_file_t *f) {
+  ob_uring_t *r = &f->ring;
+  struct io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  r->fd = (int)syscall(__NR_io_uring_setup, 2, &p);
+  if (r->fd < 0)
+    return -1;
+
+  r->sq_map_bytes = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  r->cq_map_bytes = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    if (r->cq_map_bytes > r->sq_map_bytes)
+      r->sq_map_bytes = r->cq_map_bytes;
+    r->cq_map_bytes = r->sq_map_bytes;
+  }
+  r->sq_map = mmap(NULL, r->sq_map_bytes, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+  if (r->sq_map == MAP_FAILED)
+    goto fail_fd;
+  if (p.features & IORING_FEAT_SINGLE_MMAP)
+    r->cq_map = r->sq_map;
+  else {
+    r->cq_map = mmap(NULL, r->cq_map_bytes, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+    if (r->cq_map == MAP_FAILED)
+      goto fail_sq;
+  }
+  r->sqes_bytes = p.sq_entries * sizeof(struct io_uring_sqe);
+  r->sqes = mmap(NULL, r->sqes_bytes, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+  if (r->sqes == MAP_FAILED)
+    goto fail_cq;
+
+  char *sq = r->sq_map, *cq = r->cq_map;
+  r->sq_head = (unsigned *)(sq + p.sq_off.head);
+  r->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+  r->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+  r->sq_array = (unsigned *)(sq + p.sq_off.array);
+  r->cq_head = (unsigned *)(cq + p.cq_off.head);
+  r->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+  r->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+  r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+  // register both buffers once: the kernel pins them and skips the
+  // per-write page lookups (IORING_OP_WRITE_FIXED)
+  struct iovec iov[2] = {{f->buf[0], f->buf_bytes}, {f->buf[1], f->buf_bytes}};
+  if (syscall(__NR_io_uring_register, r->fd, IORING_REGISTER_BUFFERS, iov, 2) <
+      0)
+    goto fail_sqes;
+  return 0;
+
+fail_sqes:
+  munmap(r->sqes, r->sqes_bytes);
+fail_cq:
+  if (r->cq_map != r->sq_map)
+    munmap(r->cq_map, r->cq_map_bytes);
+fail_sq:
+  munmap(r->sq_map, r->sq_map_bytes);
+fail_fd:
+  close(r->fd);
+  return -1;
+}
+
+static void uring_teardown(ob_file_t *f) {
+  ob_uring_t *r = &f->ring;
+  munmap(r->sqes, r->sqes_bytes);
+  if (r->cq_map != r->sq_map)
+    munmap(r->cq_map, r->cq_map_bytes);
+  munmap(r->sq_map, r->sq_map_bytes);
+  close(r->fd); // also unregisters the buffers
+}
+
+static int uring_submit(ob_file_t *f, int b, size_t len, off_t off) {
+  ob_uring_t *r = &f->ring;
+  unsigned tail = *r->sq_tail;
+  unsigned idx = tail & *r->sq_mask;
+  struct io_uring_sqe *sqe = &r->sqes[idx];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_WRITE_FIXED;
+  sqe->fd = f->fd;
+  sqe->addr = (uint64_t)(uintptr_t)f->buf[b];
+  sqe->len = (uint32_t)len;
+  sqe->off = (uint64_t)off;
+  sqe->buf_index = (uint16_t)b;
+  sqe->user_data = (uint64_t)b;
+  r->sq_array[idx] = idx;
+  __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+  for (;;) {
+    long ret = syscall(__NR_io_uring_enter, r->fd, 1, 0, 0, NULL, 0);
+    if (ret > 0)
+      break;
+    if (ret == 0 || errno != EINTR)
+      return -1; // nothing submitted: the buffer was never handed over
+  }
+  f->in_flight[b] = 1;
+  f->pending_len[b] = len;
+  f->pending_off[b] = off;
+  return 0;
+}
+
+// Reap completions until buffer b is free again; on failure the write of
+// b may still be running and b must not be touched
+static int uring_wait(ob_file_t *f, int b) {
+  ob_uring_t *r = &f->ring;
+  while (f->in_flight[b]) {
+    unsigned head = *r->cq_head;
+    if (head == __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+      long ret = syscall(__NR_io_uring_enter, r->fd, 0, 1,
+                         IORING_ENTER_GETEVENTS, NULL, 0);
+      if (ret < 0 && errno != EINTR) {
+        f->error = 1;
+        return -1;
+      }
+      continue;
+    }
+    struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+    int done = (int)cqe->user_data;
+    int res = cqe->res;
+    __atomic_store_n(r->cq_head, head + 1, __ATOMIC_RELEASE);
+
+    f->in_flight[done] = 0;
+    if (res < 0) {
+      f->error = 1;
+    } else if ((size_t)res < f->pending_len[done]) {
+      // short write: finish the remainder synchronously
+      if (pwrite_all(f->fd, f->buf[done] + res,
+                     f->pending_len[done] - (size_t)res,
+                     f->pending_off[done] + res) != 0)
+        f->error = 1;
+    }
+  }
+  return f->error ? -1 : 0;
+}
+
+#endif // __linux__
+
+/*============================================================================
+ * PUBLIC INTERFACE
+ *===========================================================================*/
+
+ob_file_t *ob_open(const char *path, const char *mode, ob_backend_t backend,
+                   size_t buf_bytes) {
+  ob_file_t *f = calloc(1, sizeof(*f));
+  if (!f)
+    return NULL;
+  f->backend = backend;
+  f->buf_bytes = (buf_bytes + OB_ALIGN - 1) / OB_ALIGN * OB_ALIGN;
+  f->fd = -1;
+  f->buf[0] = aligned_alloc(OB_ALIGN, f->buf_bytes);
+  f->buf[1] = aligned_alloc(OB_ALIGN, f->buf_bytes);
+  if (!f->buf[0] || !f->buf[1])
+    goto fail;
+
+  int append = (mode[0] == 'a');
+  if (backend == OB_STDIO) {
+    f->fp = fopen(path, append ? "a" : "w");
+    if (!f->fp)
+      goto fail;
+    return f;
+  }
+
+  f->fd = open(path, O_WRONLY | O_CREAT | (append ? 0 : O_TRUNC), 0644);
+  if (f->fd < 0)
+    goto fail;
+  f->offset = append ? lseek(f->fd, 0, SEEK_END) : 0;
+  if (f->offset < 0)
+    goto fail;
+
+#ifdef __linux__
+  if (backend == OB_URING) {
+    f->spare = aligned_alloc(OB_ALIGN, f->buf_bytes);
+    if (!f->spare)
+      goto fail;
+    if (uring_setup(f) != 0) {
+      f->backend = OB_PWRITE; // io_uring not available: fall back
+      free(f->spare);
+      f->spare = NULL;
+    }
+  }
+#else
+  f->backend = OB_PWRITE;
+#endif
+  return f;
+
+fail:
+  if (f->fd >= 0)
+    close(f->fd);
+  free(f->buf[0]);
+  free(f->buf[1]);
+  free(f);
+  return NULL;
+}
+
+char *ob_buf(ob_file_t *f) { return f->buf[f->cur]; }
+
+int ob_submit(ob_file_t *f, size_t len) {
+  if (len == 0)
+    return f->error ? -1 : 0;
+  switch (f->backend) {
+  case OB_STDIO:
+    if (fwrite(f->buf[f->cur], 1, len, f->fp) != len)
+      f->error = 1;
+    break;
+  case OB_PWRITE:
+    if (pwrite_all(f->fd, f->buf[f->cur], len, f->offset) != 0)
+      f->error = 1;
+    f->offset += (off_t)len;
+    break;
+  case OB_URING:
+#ifdef __linux__
+    if (f->error)
+      break; // the output is lost already; keep the buffers out of reach
+    if (uring_submit(f, f->cur, len, f->offset) != 0) {
+      f->error = 1;
+      break;
+    }
+    f->offset += (off_t)len;
+    // hand the other buffer back once its previous write has completed
+    f->cur ^= 1;
+    if (uring_wait(f, f->cur) != 0 && f->in_flight[f->cur]) {
+      // the kernel may still read it: the caller fills the spare instead
+      f->retired[f->cur] = f->buf[f->cur];
+      f->buf[f->cur] = f->spare;
+      f->spare = NULL;
+    }
+#endif
+    break;
+  }
+  return f->error ? -1 : 0;
+}
+
+int ob_close(ob_file_t *f) {
+  int status = 0;
+  if (f->backend == OB_STDIO) {
+    if (fclose(f->fp) != 0)
+      status = -1;
+  } else {
+#ifdef __linux__
+    if (f->backend == OB_URING) {
+      // a write that cannot be reaped leaves f->error set; the kernel keeps
+      // the registered pages pinned until the ring is gone
+      for (int b = 0; b < 2; b++)
+        if (!f->retired[b])
+          uring_wait(f, b);
+      uring_teardown(f);
+      free(f->retired[0]);
+      free(f->retired[1]);
+      free(f->spare);
+    }
+#endif
+    if (close(f->fd) != 0)
+      status = -1;
+  }
+  if (f->error)
+    status = -1;
+  free(f->buf[0]);
+  free(f->buf[1]);
+  free(f);
+  return status;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file rec_writer.c
+ * @brief Writer thread: drains the producer rings, formats, writes
+ */
+
+#include "../include/rec_writer.h"
+#include "../include/out_backend.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RW_MAX_SINKS 16
+#define RW_BUFFER_BYTES (1u << 20) // text buffered per file before a write
+#define RW_IDLE_NS 20000           // writer back-off when all rings are empty
+
+typedef struct {
+  ob_file_t *out; // double-buffered file (stdio, pwrite or io_uring)
+  rw_format_fn fmt;
+  const void *ctx;
+  char *buf; // buffer being filled, owned by out
+  size_t used;
+} rw_sink_t;
+
+struct rec_writer {
+  int nproducers, nsinks, started, io_error;
+  spsc_ring_t *rings;
+  _Atomic int *done; // per producer
+  rw_sink_t sinks[RW_MAX_SINKS];
+  pthread_t thread;
+};
+
+static void sink_flush(rec_writer_t *w, rw_sink_t *s) {
+  if (s->used > 0 && ob_submit(s->out, s->used) != 0)
+    w->io_error = 1;
+  s->buf = ob_buf(s->out); // the other buffer, while this one is written
+  s->used = 0;
+}
+
+// Format the ready records of one ring (at most one ring's worth, so a busy
+// producer cannot starve the others); returns how many were consumed
+static size_t drain_ring(rec_writer_t *w, spsc_ring_t *r) {
+  size_t total = 0;
+  const spsc_record_t *rec;
+  size_t n;
+  while (total <= r->mask && (n = spsc_peek(r, &rec)) > 0) {
+    for (size_t i = 0; i < n; i++) {
+      rw_sink_t *s = &w->sinks[rec[i].sink];
+      if (s->used + RW_MAX_LINE > RW_BUFFER_BYTES)
+        sink_flush(w, s);
+      s->used += s->fmt(s->buf + s->used, &rec[i], s->ctx);
+    }
+    spsc_release(r, n);
+    total += n;
+  }
+  return total;
+}
+
+static int all_done(rec_writer_t *w) {
+  for (int p = 0; p < w->nproducers; p++)
+    if (!atomic_load_explicit(&w->done[p], memory_order_acquire))
+      return 0;
+  return 1;
+}
+
+static void *writer_main(void *arg) {
+  rec_writer_t *w = arg;
+  const struct timespec idle = {0, RW_IDLE_NS};
+  for (;;) {
+    // read the flags before draining: a producer's records are visible
+    // once its done flag is, so an empty pass after that means finished
+    int done = all_done(w);
+    size_t got = 0;
+    for (int p = 0; p < w->nproducers; p++)
+      got += drain_ring(w, &w->rings[p]);
+    if (got == 0) {
+      if (done)
+        break;
+      nanosleep(&idle, NULL);
+    }
+  }
+  for (int s = 0; s < w->nsinks; s++)
+    sink_flush(w, &w->sinks[s]);
+  return NULL;
+}
+
+rec_writer_t *rw_create(int nproducers, size_t ring_records) {
+  rec_writer_t *w = calloc(1, sizeof(*w));
+  if (!w)
+    return NULL;
+  w->nproducers = nproducers;
+  w->rings = aligned_alloc(64, (size_t)nproducers * sizeof(spsc_ring_t));
+  w->done = calloc((size_t)nproducers, sizeof(*w->done));
+  if (!w->rings || !w->done) {
+    free(w->rings);
+    free(w->done);
+    free(w);
+    return NULL;
+  }
+  for (int p = 0; p < nproducers; p++) {
+    if (spsc_init(&w->rings[p], ring_records) != 0) {
+      while (p-- > 0)
+        spsc_free(&w->rings[p]);
+      free(w->rings);
+      free(w->done);
+      free(w);
+      return NULL;
+    }
+    atomic_init(&w->done[p], 0);
+  }
+  return w;
+}
+
+int rw_add_sink(rec_writer_t *w, const char *path, const char *mode,
+                rw_format_fn fmt, const void *ctx) {
+  if (w->nsinks == RW_MAX_SINKS || w->started)
+    return -1;
+  rw_sink_t *s = &w->sinks[w->nsinks];
+  s->out = ob_open(path, mode, ob_backend_from_env(), RW_BUFFER_BYTES);
+  if (!s->out)
+    return -1;
+  s->buf = ob_buf(s->out);
+  s->fmt = fmt;
+  s->ctx = ctx;
+  s->used = 0;
+  return w->nsinks++;
+}
+
+int rw_start(rec_writer_t *w) {
+  if (pthread_create(&w->thread, NULL, writer_main, w) != 0)
+    return -1;
+  w->started = 1;
+  return 0;
+}
+
+spsc_ring_t *rw_producer_ring(rec_writer_t *w, int producer) {
+  return &w->rings[producer];
+}
+
+void rw_producer_done(rec_writer_t *w, int producer) {
+  atomic_store_explicit(&w->done[producer], 1, memory_order_release);
+}
+
+int rw_finish(rec_writer_t *w) {
+  for (int p = 0; p < w->nproducers; p++)
+    rw_producer_done(w, p);
+  if (w->started)
+    pthread_join(w->thread, NULL);
+  else
+    writer_main(w); // never started: drain on the calling thread
+
+  int status = w->io_error ? -1 : 0;
+  for (int s = 0; s < w->nsinks; s++) {
+    if (ob_close(w->sinks[s].out) != 0)
+      status = -1;
+  }
+  for (int p = 0; p < w->nproducers; p++)
+    spsc_free(&w->rings[p]);
+  free(w->rings);
+  free(w->done);
+  free(w);
+  return status;
+}
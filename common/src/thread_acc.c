@@ -0,0 +1,83 @@
+/**
+ * @file thread_acc.c
+ * @brief Padded per-thread accumulator slabs and their tree reduction
+ */
+
+#include "../include/thread_acc.h"
+#include "../include/exact_acc.h"
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+static size_t round_up(size_t n, size_t align) {
+  return (n + align - 1) / align * align;
+}
+
+int tacc_init(thread_acc_t *a, int nthreads, size_t nelem, size_t elem_size) {
+  size_t bytes = nelem * elem_size;
+  a->nthreads = nthreads;
+  a->nelem = nelem;
+  a->elem_size = elem_size;
+  a->base = NULL;
+  // large slabs get whole pages so first touch can place them per node
+  a->slab_bytes = round_up(bytes > 0 ? bytes : 1,
+                           bytes >= TACC_PAGE ? TACC_PAGE : TACC_CACHE_LINE);
+  a->map_bytes = round_up((size_t)nthreads * a->slab_bytes, TACC_PAGE);
+
+  // anonymous mapping: page aligned, and no page is backed until touched
+  void *p = mmap(NULL, a->map_bytes, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED)
+    return -1;
+  a->base = p;
+
+  if (pthread_barrier_init(&a->barrier, NULL, (unsigned)nthreads) != 0) {
+    munmap(a->base, a->map_bytes);
+    a->base = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+void tacc_touch(thread_acc_t *a, int tid) {
+  memset(tacc_slab(a, tid), 0, a->slab_bytes);
+}
+
+void tacc_reduce(thread_acc_t *a, int tid, tacc_merge_fn merge) {
+  // level s: thread tid (multiple of 2s) absorbs the slab of tid + s
+  for (int s = 1; s < a->nthreads; s *= 2) {
+    pthread_barrier_wait(&a->barrier);
+    if (tid % (2 * s) == 0 && tid + s < a->nthreads)
+      merge(tacc_slab(a, tid), tacc_slab(a, tid + s), a->nelem);
+  }
+  pthread_barrier_wait(&a->barrier);
+}
+
+void tacc_free(thread_acc_t *a) {
+  if (!a->base)
+    return;
+  pthread_barrier_destroy(&a->barrier);
+  munmap(a->base, a->map_bytes);
+  a->base = NULL;
+}
+
+void tacc_merge_i64(void *dst, const void *src, size_t nelem) {
+  int64_t *d = dst;
+  const int64_t *s = src;
+  for (size_t i = 0; i < nelem; i++)
+    d[i] += s[i];
+}
+
+void tacc_merge_exact_acc(void *dst, const void *src, size_t nelem) {
+  exact_acc_t *d = dst;
+  const exact_acc_t *s = src;
+  for (size_t i = 0; i < nelem; i++)
+    exact_acc_merge(&d[i], &s[i]);
+}
+
+void tacc_merge_exact_ratio(void *dst, const void *src, size_t nelem) {
+  exact_ratio_t *d = dst;
+  const exact_ratio_t *s = src;
+  for (size_t i = 0; i < nelem; i++)
+    exact_ratio_merge(&d[i], &s[i]);
+}
@@ -6,11 +6,23 @@ cd "$BASE"
 
 echo "=== Compiling Programs ==="
 cd "$BASE/01_1d_random_walk"
-gcc -O3 src/main_dat.c src/seed_generator.c -o program_dat -Iinclude -lm
+gcc -O3 src/main_dat.c src/seed_generator.c ../common/src/rec_writer.c ../common/src/out_backend.c -o program_dat -Iinclude -lm -pthread
 cd "$BASE/02_2d_random_walk"
-gcc -O3 src/2d_ran_walk.c src/seed_generator.c -o program_2d -Iinclude -lm
+gcc -O3 src/2d_ran_walk.c src/seed_generator.c ../common/src/thread_acc.c ../common/src/rec_writer.c ../common/src/out_backend.c -o program_2d -Iinclude -lm -pthread
 cd "$BASE/03_diffusion_coefficient"
 gcc -O3 src/diff_coef.c src/seed_generator.c src/pcg32.c -o program_diff -Iinclude -lm
+cd "$BASE/04_large_deviations"
+gcc -O3 src/cloning.c -o program_ld -lm
+cd "$BASE/05_first_passage"
+gcc -O3 src/first_passage.c -o program_fpt -lm
+cd "$BASE/06_self_avoiding_walk"
+gcc -O3 src/pivot.c -o program_saw -lm
+cd "$BASE/07_graph_walks"
+gcc -O3 src/graph_walk.c -o program_graph -lm
+cd "$BASE/08_tasep_ring"
+gcc -O3 src/tasep.c -o program_tasep -lm
+cd "$BASE/09_single_file_diffusion"
+gcc -O3 src/single_file.c -o program_sfd -lm
 
 mkdir -p "$BASE/plots"
 
@@ -26,6 +38,14 @@ rm -f ../results/dat/ran_gen.dat ../results/dat/x2_mean.dat
 # Plot 3
 ../program_dat 5000 1000
 cp ../results/dat/x2_mean.dat ../results/dat/x2_mean_5000.dat
+# Plot 13 (CTRW: exponential and Pareto alpha = 0.5 waiting times)
+../program_dat 10000 100000 ctrw=exp
+cp ../results/dat/x2_mean.dat ../results/dat/x2_mean_ctrw_exp.dat
+../program_dat 20000 100000 ctrw=pareto alpha=0.5
+cp ../results/dat/x2_mean.dat ../results/dat/x2_mean_ctrw_pareto.dat
+rm -f ../results/dat/ran_gen.dat
+# Plot 14 (Levy flight, alpha = 1.5)
+../program_dat 2000 100000 levy=1.5
 cd ..
 cd ..
 
@@ -33,23 +53,34 @@ echo "=== Generating Data for 2D Random Walk ==="
 cd "$BASE/02_2d_random_walk"
 mkdir -p results/dat
 cd src
-rm -f ../results/dat/*.dat
-# Plot 4
+rm -f ../results/dat/*.dat ../results/dat/*.bin
+# Plot 4 (full trace kept as traj_1M.dat, plot reads the decimated binary)
 echo "1 1000000 1000000" | ../program_2d
 cp ../results/dat/2d_ran_walk_trace.dat ../results/dat/traj_1M.dat
+cp ../results/dat/2d_ran_walk_trace_dec.bin ../results/dat/traj_1M_dec.bin
 
-# Plot 5 & 6
-rm -f ../results/dat/2d_ran_gen_t_100000.dat
-echo "10000 1000 1000" | ../program_2d
-mv ../results/dat/2d_ran_gen_t_100000.dat ../results/dat/res_1000.dat
+# Plot 5 & 6 (histograms binned by the program, bin widths as in the plots)
+for t_bin in 1000:8 10000:25 100000:80; do
+    T=${t_bin%%:*}
+    rm -f ../results/dat/2d_ran_gen_t_100000.dat
+    echo "10000 $T $T" | ../program_2d bin=${t_bin##*:} threads=$(nproc)
+    mv ../results/dat/2d_ran_gen_t_100000.dat ../results/dat/res_$T.dat
+    mv ../results/dat/2d_P_x1.dat ../results/dat/P_x1_$T.dat
+    mv ../results/dat/2d_P_x1x2.bin ../results/dat/P_x1x2_$T.bin
+done
 
-rm -f ../results/dat/2d_ran_gen_t_100000.dat
-echo "10000 10000 10000" | ../program_2d
-mv ../results/dat/2d_ran_gen_t_100000.dat ../results/dat/res_10000.dat
+# Distinct sites visited S(t), in its own tree (results/visits/results/dat):
+# the run also writes the trace, per-run and histogram files, which must
+# not replace or mix with those of plots 4-6
+mkdir -p ../results/visits/src ../results/visits/results/dat
+cd ../results/visits/src
+echo "1000 1000000 1000000" | ../../../program_2d visits=1 threads=$(nproc)
+cd ../../../src
+# Cover times of the 64 x 64 torus (writes only 2d_cover.dat)
+echo "1000 100000000 1" | ../program_2d torus=64 threads=$(nproc)
 
-rm -f ../results/dat/2d_ran_gen_t_100000.dat
-echo "10000 100000 100000" | ../program_2d
-mv ../results/dat/2d_ran_gen_t_100000.dat ../results/dat/res_100000.dat
+# Plot 14 (Levy flight, alpha = 1.5)
+echo "2000 100000 1" | ../program_2d levy=1.5 threads=$(nproc)
 cd ..
 cd ..
 
@@ -57,18 +88,109 @@ echo "=== Generating Data for Diffusion Coefficient ==="
 cd "$BASE/03_diffusion_coefficient"
 mkdir -p results
 cd src
+# MCRW_DAEMON=1: run the lattice gas jobs concurrently in one mcrwd process
+# (same results as program_diff, no per-run process startup)
+if [ -n "$MCRW_DAEMON" ]; then
+    bash "$BASE/libmcrw/build.sh"
+    SOCK="/tmp/mcrwd.$$.sock"
+    "$BASE/libmcrw/bin/mcrwd" socket="$SOCK" > /dev/null &
+    DAEMON_PID=$!
+    CLIENTS=()
+    # wait up to 10 s for the socket, giving up if the daemon has exited
+    for try in $(seq 100); do
+        [ -S "$SOCK" ] && break
+        if ! kill -0 "$DAEMON_PID" 2> /dev/null; then
+            echo "mcrwd exited before opening $SOCK" >&2
+            exit 1
+        fi
+        sleep 0.1
+    done
+    if [ ! -S "$SOCK" ]; then
+        echo "mcrwd did not open $SOCK within 10 s" >&2
+        kill "$DAEMON_PID" 2> /dev/null || true
+        exit 1
+    fi
+fi
+run_diff() { # L rho output
+    echo "Running diff L=$1 rho=$2"
+    if [ -n "$MCRW_DAEMON" ]; then
+        "$BASE/libmcrw/bin/mcrw_client" socket="$SOCK" lgas L=$1 rho=$2 sweeps=2000 samples=50 > "$3" &
+        CLIENTS+=($!)
+    else
+        ../program_diff $1 $2 2000 100 50 "$3"
+    fi
+}
 # Plot 7 (L=80, rho=0.1..0.9)
 for rho in 0.1 0.2 0.3 0.4 0.5 0.6 0.7 0.8 0.9; do
-    echo "Running diff L=80 rho=$rho"
-    ../program_diff 80 $rho 2000 100 50 ../results/out_rho${rho}_L80.dat
+    run_diff 80 $rho ../results/out_rho${rho}_L80.dat
 done
 
 # Plot 8 (rho=0.6, L=20,40,80)
 for L in 20 40 80; do
-    echo "Running diff L=$L rho=0.6"
-    ../program_diff $L 0.6 2000 100 50 ../results/out_rho0.6_L${L}.dat
+    run_diff $L 0.6 ../results/out_rho0.6_L${L}.dat
+done
+if [ -n "$MCRW_DAEMON" ]; then
+    for pid in "${CLIENTS[@]}"; do wait $pid; done
+    "$BASE/libmcrw/bin/mcrw_client" socket="$SOCK" shutdown
+    wait $DAEMON_PID
+fi
+cd ..
+cd ..
+
+echo "=== Generating Data for Large Deviations ==="
+cd "$BASE/04_large_deviations"
+mkdir -p results/dat
+# Plot 9 & 10 (SCGF and reweighted tails of x1 at t = 1000)
+./program_ld 1 2000 1000 results/dat/ld_1d
+./program_ld 2 2000 1000 results/dat/ld_2d
+cd ..
+
+echo "=== Generating Data for First Passage ==="
+cd "$BASE/05_first_passage"
+mkdir -p results/dat
+# Plot 11 (survival: 1D point a=10, 2D line x1=10, exit from the 2D box L=50)
+./program_fpt 1 100000 1000000 results/dat/fpt_1d_point a=10
+./program_fpt 2 100000 1000000 results/dat/fpt_2d_line target=line a=10
+./program_fpt 2 100000 1000000 results/dat/fpt_2d_box target=box L=50
+cd ..
+
+echo "=== Generating Data for Self-Avoiding Walks ==="
+cd "$BASE/06_self_avoiding_walk"
+mkdir -p results/dat
+rm -f results/dat/saw_R2.dat
+# Plot 12 (<R^2(N)>/N^(3/2) from pivot runs, N = 10 .. 30000)
+for N in 10 30 100 300 1000 3000 10000 30000; do
+    ./program_saw $N 1000000 results/dat/saw
 done
 cd ..
+
+echo "=== Generating Data for Graph Walks ==="
+cd "$BASE/07_graph_walks"
+mkdir -p results/dat
+# Plot 15 (return probability P_0(t) on 10^6-node graphs, RCM order)
+./program_graph lattice:1000 100000 1000 results/dat/graph_lattice
+./program_graph regular:1000000:3 100000 1000 results/dat/graph_regular
+./program_graph smallworld:1000000:2:0.1 100000 1000 results/dat/graph_smallworld
+cd ..
+
+echo "=== Generating Data for TASEP ==="
+cd "$BASE/08_tasep_ring"
+mkdir -p results/dat
+rm -f results/dat/tasep_p*_current.dat
+# Plot 16 (steady current J(rho), parallel update, ring of 65536 sites)
+for p in 0.5 0.75; do
+    for rho in 0.05 0.1 0.15 0.2 0.25 0.3 0.35 0.4 0.45 0.5 0.55 0.6 0.65 0.7 0.75 0.8 0.85 0.9 0.95; do
+        ./program_tasep 65536 $rho 20000 results/dat/tasep_p$p p=$p
+    done
+done
+cd ..
+
+echo "=== Generating Data for Single-File Diffusion ==="
+cd "$BASE/09_single_file_diffusion"
+mkdir -p results/dat
+# Plot 17 (tracer <Dx^2(t)> on a ring of 20000 sites, up to 10^6 sweeps)
+./program_sfd 20000 0.5 1000000 4 results/dat/sfd_rho0.5
+./program_sfd 20000 0.2 1000000 8 results/dat/sfd_rho0.2
 cd ..
 
 echo "Data Generation Complete!"
@@ -0,0 +1,23 @@
+#!/bin/bash
+# Build libmcrw: static (lib/libmcrw.a) and shared (lib/libmcrw.so) library,
+# plus the simulation daemon, its client and the multi-process launcher
+# (bin/mcrwd, bin/mcrw_client, bin/mcrw_fork)
+# Link with: -I<repo>/libmcrw/include -I<repo>/common/include
+#            -L<repo>/libmcrw/lib -lmcrw
+set -e
+
+BASE="$(cd "$(dirname "$0")" && pwd)"
+cd "$BASE"
+mkdir -p lib obj bin
+INC="-Iinclude -I../common/include" # for the headers mcrw.h includes
+
+for src in src/*.c; do
+    gcc -O3 -fPIC $INC -c "$src" -o "obj/$(basename "${src%.c}").o"
+done
+ar rcs lib/libmcrw.a obj/*.o
+gcc -shared obj/*.o -o lib/libmcrw.so
+rm -rf obj
+
+gcc -O3 $INC tools/mcrwd.c lib/libmcrw.a -o bin/mcrwd -pthread -lm
+gcc -O3 $INC tools/mcrw_client.c -o bin/mcrw_client
+gcc -O3 $INC tools/mcrw_fork.c lib/libmcrw.a -o bin/mcrw_fork -lm
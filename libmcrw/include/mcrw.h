@@ -0,0 +1,193 @@
+/**
+ * @file mcrw.h
+ * @brief libmcrw: the walk, ensemble and lattice-gas engines as a library
+ *
+ * The three programs drive these simulations from main() and exchange data
+ * through files under results/. libmcrw exposes the same engines to other C
+ * code: every call is reentrant (no global RNG or lattice), trajectories go
+ * into caller-supplied buffers and observables are reported through
+ * callbacks or the exact accumulators of exact_acc.h.
+ *
+ * Random streams are the ones the programs use: the seed generator is
+ * seeded with mcrw_seed_t and run r draws seeds number 2r and 2r+1 from it
+ * (reached by jump-ahead, so any range of runs can be simulated on its own).
+ * With MCRW_SEED_DEFAULT, run r of mcrw_ensemble1d/2d is run r of
+ * program_dat/program_2d and consecutive mcrw_lgas_sample() calls are the
+ * samples of program_diff.
+ *
+ * Typical use:
+ *
+ *   mcrw_ens_cfg_t cfg = {MCRW_SEED_DEFAULT, 0, 5000, 1000, 0};
+ *   int32_t *x = malloc(cfg.steps * sizeof(*x));
+ *   exact_acc_t *x2 = calloc(cfg.steps, sizeof(*x2));
+ *   mcrw_ensemble1d(&cfg, x, x2, NULL, NULL);
+ *   ... exact_acc_mean(&x2[t]) is <x^2> after t+1 steps ...
+ *
+ * Build with libmcrw/build.sh (static and shared library in libmcrw/lib).
+ * exact_acc.h and sim_common.h live in common/include, which must be on
+ * the include path next to libmcrw/include.
+ */
+
+#ifndef MCRW_H
+#define MCRW_H
+
+#include "exact_acc.h"
+#include "sim_common.h"
+#include <stdint.h>
+
+/*============================================================================
+ * SEEDING
+ *===========================================================================*/
+
+/**
+ * @brief State and sequence of the seed generator (seedgen_init arguments)
+ */
+typedef struct {
+  uint64_t state, seq;
+} mcrw_seed_t;
+
+// seeding used by all the programs (sim_common.h)
+#define MCRW_SEED_DEFAULT ((mcrw_seed_t){SIM_SEED_STATE, SIM_SEED_SEQ})
+
+/**
+ * @brief The two 32-bit seeds run `run` initializes its generator with
+ */
+void mcrw_run_seeds(const mcrw_seed_t *seed, long run, uint32_t *seed1,
+                    uint32_t *seed2);
+
+/*============================================================================
+ * SINGLE WALKS
+ *===========================================================================*/
+
+/**
+ * @brief One 1D walk: x[i] = position after i+1 steps, i < steps
+ */
+void mcrw_walk1d(const mcrw_seed_t *seed, long run, long steps, int32_t *x);
+
+/**
+ * @brief One 2D lattice walk: (x[i], y[i]) = position after i+1 steps
+ */
+void mcrw_walk2d(const mcrw_seed_t *seed, long run, long steps, int32_t *x,
+                 int32_t *y);
+
+/*============================================================================
+ * ENSEMBLES
+ *===========================================================================*/
+
+/**
+ * @brief Ensemble of independent walks started at the origin
+ */
+typedef struct {
+  mcrw_seed_t seed;
+  long first_run; // index of the first run (position in the seed stream)
+  long runs;      // runs first_run .. first_run + runs - 1
+  long steps;     // steps per walk
+  long t_sample;  // 2D: time at which the position moments are taken
+} mcrw_ens_cfg_t;
+
+/**
+ * @brief Called after every run with its trajectory
+ *
+ * @return 0 to continue, nonzero to stop the ensemble
+ */
+typedef int (*mcrw_run1d_fn)(void *user, long run, const int32_t *x,
+                             long steps);
+typedef int (*mcrw_run2d_fn)(void *user, long run, const int32_t *x,
+                             const int32_t *y, long steps);
+
+/**
+ * @brief Run a 1D ensemble
+ *
+ * @param x  trajectory buffer, cfg->steps entries
+ * @param x2 NULL or cfg->steps accumulators; x^2 after i+1 steps is added to
+ *           x2[i] (the x2_mean.dat estimator)
+ * @param fn NULL or per-run callback
+ * @return Number of completed runs
+ */
+long mcrw_ensemble1d(const mcrw_ens_cfg_t *cfg, int32_t *x, exact_acc_t *x2,
+                     mcrw_run1d_fn fn, void *user);
+
+/**
+ * @brief Run a 2D ensemble
+ *
+ * @param x,y          trajectory buffers, cfg->steps entries each
+ * @param acc_x,acc_y  NULL or accumulators of x and y at time cfg->t_sample
+ *                     (ignored unless 1 <= t_sample <= steps)
+ * @return Number of completed runs
+ */
+long mcrw_ensemble2d(const mcrw_ens_cfg_t *cfg, int32_t *x, int32_t *y,
+                     exact_acc_t *acc_x, exact_acc_t *acc_y, mcrw_run2d_fn fn,
+                     void *user);
+
+/*============================================================================
+ * LATTICE GAS
+ *===========================================================================*/
+
+/**
+ * @brief Lattice gas on an L x L periodic lattice (program_diff)
+ */
+typedef struct {
+  long L;
+  double rho;            // occupation probability of each site, in (0,1)
+  long num_sweeps;       // sweeps per sample (1 sweep = N move attempts)
+  long num_measurements; // must divide num_sweeps (program_diff: 100)
+  mcrw_seed_t seed;
+  long stream; // seed pair the generator starts from (program_diff: 0);
+               // independent workers use distinct streams
+} mcrw_lgas_cfg_t;
+
+typedef struct mcrw_lgas mcrw_lgas_t;
+
+/**
+ * @brief Raw generator state, for checkpointing a lattice gas between samples
+ */
+typedef struct {
+  uint64_t state, inc;
+} mcrw_rng_t;
+
+/**
+ * @brief Called at every measurement with the exact sum of Delta r^2
+ *
+ * @return 0 to continue, nonzero to abandon the sample
+ */
+typedef int (*mcrw_meas_fn)(void *user, long sample, long sweep,
+                            int64_t sum_dr2, long particles);
+
+/**
+ * @brief Allocate a lattice gas and seed its generator
+ *
+ * @return NULL if the configuration is invalid or memory is short
+ */
+mcrw_lgas_t *mcrw_lgas_create(const mcrw_lgas_cfg_t *cfg);
+
+/**
+ * @brief Reconfigure and reseed without reallocating
+ *
+ * Used to keep one lattice per worker across jobs (mcrwd). The new lattice
+ * may not have more sites than the one the context was created for.
+ * @return 0 on success, -1 if cfg is invalid or too large
+ */
+int mcrw_lgas_reset(mcrw_lgas_t *g, const mcrw_lgas_cfg_t *cfg);
+
+/**
+ * @brief Fill a fresh lattice and run one sample of num_sweeps sweeps
+ *
+ * @param acc NULL or num_measurements ratio accumulators; measurement m adds
+ *            (sum of Delta r^2, particle count) to acc[m]
+ * @return Particle count, or -1 if fn stopped the sample
+ */
+long mcrw_lgas_sample(mcrw_lgas_t *g, exact_ratio_t *acc, mcrw_meas_fn fn,
+                      void *user);
+
+/**
+ * @brief Save / restore the generator between samples
+ *
+ * Samples only share the random stream, so restoring the state saved after
+ * sample k and calling mcrw_lgas_sample() continues with sample k+1.
+ */
+void mcrw_lgas_get_rng(const mcrw_lgas_t *g, mcrw_rng_t *rng);
+void mcrw_lgas_set_rng(mcrw_lgas_t *g, const mcrw_rng_t *rng);
+
+void mcrw_lgas_destroy(mcrw_lgas_t *g);
+
+#endif // MCRW_H
@@ -0,0 +1,173 @@
+/**
+ * @file mcrw_lgas.c
+ * @brief Lattice gas engine (the simulation of program_diff as a context)
+ *
+ * Same moves and the same use of the random stream as diff_coef.c, so a
+ * context created with MCRW_SEED_DEFAULT reproduces its samples in order.
+ * The unwrapped positions are kept as displacements from the start site,
+ * which is all the Delta r^2 measurement needs.
+ */
+
+#include "../include/mcrw.h"
+#include "../../common/include/pcg32.h"
+#include <stdlib.h>
+
+#define LGAS_EMPTY (-1)
+
+struct mcrw_lgas {
+  long capacity; // sites allocated (largest L*L usable without reallocating)
+  long L, volume, num_sweeps, num_measurements, period;
+  double rho;
+  long sample; // samples started so far
+  pcg32_random_t rng;
+  int32_t *site;     // particle index per site or LGAS_EMPTY, x * L + y
+  int32_t *pos;      // wrapped position [p][2]
+  int32_t *disp;     // unwrapped displacement [p][2]
+  int32_t *plus_nb;  // periodic neighbours along one axis
+  int32_t *minus_nb;
+};
+
+static int lgas_cfg_valid(const mcrw_lgas_cfg_t *cfg) {
+  return cfg->L >= 2 && cfg->L <= 46340 && cfg->rho > 0.0 && cfg->rho < 1.0 &&
+         cfg->num_measurements > 0 && cfg->num_sweeps > 0 && cfg->stream >= 0 &&
+         cfg->num_sweeps % cfg->num_measurements == 0;
+}
+
+mcrw_lgas_t *mcrw_lgas_create(const mcrw_lgas_cfg_t *cfg) {
+  if (!lgas_cfg_valid(cfg))
+    return NULL;
+
+  mcrw_lgas_t *g = calloc(1, sizeof(*g));
+  if (!g)
+    return NULL;
+  g->capacity = cfg->L * cfg->L;
+  g->site = malloc((size_t)g->capacity * sizeof(*g->site));
+  g->pos = malloc((size_t)g->capacity * 2 * sizeof(*g->pos));
+  g->disp = malloc((size_t)g->capacity * 2 * sizeof(*g->disp));
+  g->plus_nb = malloc((size_t)cfg->L * sizeof(*g->plus_nb));
+  g->minus_nb = malloc((size_t)cfg->L * sizeof(*g->minus_nb));
+  if (!g->site || !g->pos || !g->disp || !g->plus_nb || !g->minus_nb) {
+    mcrw_lgas_destroy(g);
+    return NULL;
+  }
+  mcrw_lgas_reset(g, cfg);
+  return g;
+}
+
+int mcrw_lgas_reset(mcrw_lgas_t *g, const mcrw_lgas_cfg_t *cfg) {
+  if (!lgas_cfg_valid(cfg) || cfg->L * cfg->L > g->capacity)
+    return -1;
+  g->L = cfg->L;
+  g->volume = cfg->L * cfg->L;
+  g->rho = cfg->rho;
+  g->num_sweeps = cfg->num_sweeps;
+  g->num_measurements = cfg->num_measurements;
+  g->period = cfg->num_sweeps / cfg->num_measurements;
+  g->sample = 0;
+  for (long i = 0; i < g->L; i++) {
+    g->plus_nb[i] = (int32_t)((i + 1) % g->L);
+    g->minus_nb[i] = (int32_t)((i + g->L - 1) % g->L);
+  }
+
+  // program_diff seeds once, with the first pair of the seed stream
+  uint32_t s1, s2;
+  mcrw_run_seeds(&cfg->seed, cfg->stream, &s1, &s2);
+  pcg32_srandom_r(&g->rng, s1, s2);
+  return 0;
+}
+
+void mcrw_lgas_get_rng(const mcrw_lgas_t *g, mcrw_rng_t *rng) {
+  rng->state = g->rng.state;
+  rng->inc = g->rng.inc;
+}
+
+void mcrw_lgas_set_rng(mcrw_lgas_t *g, const mcrw_rng_t *rng) {
+  g->rng.state = rng->state;
+  g->rng.inc = rng->inc;
+}
+
+void mcrw_lgas_destroy(mcrw_lgas_t *g) {
+  if (!g)
+    return;
+  free(g->site);
+  free(g->pos);
+  free(g->disp);
+  free(g->plus_nb);
+  free(g->minus_nb);
+  free(g);
+}
+
+// Place particles independently with probability rho (initLattice)
+static long lgas_fill(mcrw_lgas_t *g) {
+  long n = 0;
+  for (long s = 0; s < g->volume; s++)
+    g->site[s] = LGAS_EMPTY;
+  for (long x = 0; x < g->L; x++) {
+    for (long y = 0; y < g->L; y++) {
+      if (pcg32_double_r(&g->rng) < g->rho) {
+        g->site[x * g->L + y] = (int32_t)n;
+        g->pos[2 * n] = (int32_t)x;
+        g->pos[2 * n + 1] = (int32_t)y;
+        g->disp[2 * n] = g->disp[2 * n + 1] = 0;
+        n++;
+      }
+    }
+  }
+  return n;
+}
+
+// One sweep: n attempts to move a random particle to a random empty
+// neighbour (updateLattice)
+static void lgas_sweep(mcrw_lgas_t *g, long n) {
+  for (long attempt = 0; attempt < n; attempt++) {
+    long p = (long)(pcg32_double_r(&g->rng) * (double)n);
+    int dir = (int)(4.0 * pcg32_double_r(&g->rng)); // 0,1,2,3
+    int32_t x = g->pos[2 * p], y = g->pos[2 * p + 1];
+    int32_t nx = x, ny = y;
+    switch (dir) {
+    case 0:
+      nx = g->plus_nb[x];
+      break;
+    case 1:
+      nx = g->minus_nb[x];
+      break;
+    case 2:
+      ny = g->plus_nb[y];
+      break;
+    default:
+      ny = g->minus_nb[y];
+      break;
+    }
+    if (g->site[nx * g->L + ny] != LGAS_EMPTY)
+      continue; // occupied: failed move
+    g->site[nx * g->L + ny] = (int32_t)p;
+    g->site[x * g->L + y] = LGAS_EMPTY;
+    g->pos[2 * p] = nx;
+    g->pos[2 * p + 1] = ny;
+    g->disp[2 * p + (dir >> 1)] += (dir & 1) ? -1 : 1;
+  }
+}
+
+static int64_t lgas_measure(const mcrw_lgas_t *g, long n) {
+  int64_t sum = 0;
+  for (long i = 0; i < 2 * n; i++)
+    sum += (int64_t)g->disp[i] * g->disp[i];
+  return sum;
+}
+
+long mcrw_lgas_sample(mcrw_lgas_t *g, exact_ratio_t *acc, mcrw_meas_fn fn,
+                      void *user) {
+  long sample = g->sample++;
+  long n = lgas_fill(g);
+  for (long sweep = 1; sweep <= g->num_sweeps; sweep++) {
+    lgas_sweep(g, n);
+    if (sweep % g->period == 0) {
+      int64_t dr2 = lgas_measure(g, n);
+      if (acc)
+        exact_ratio_add(&acc[sweep / g->period - 1], dr2, n);
+      if (fn && fn(user, sample, sweep, dr2, n) != 0)
+        return -1;
+    }
+  }
+  return n;
+}
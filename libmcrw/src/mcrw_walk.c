@@ -0,0 +1,95 @@
+/**
+ * @file mcrw_walk.c
+ * @brief Seeding, single walks and walk ensembles
+ *
+ * The step rules compare the raw 32-bit PCG output with the thresholds the
+ * programs apply to myrand() = u / 2^32, so the walks are the same:
+ *   1D: u / 2^32 > 0.5 (u > 2^31) steps right
+ *   2D: quarters of [0, 2^32) select +x, -x, +y, -y
+ */
+
+#include "../include/mcrw.h"
+#include "../../common/include/pcg32.h"
+
+void mcrw_run_seeds(const mcrw_seed_t *seed, long run, uint32_t *seed1,
+                    uint32_t *seed2) {
+  pcg32_random_t gen;
+  pcg32_srandom_r(&gen, seed->state, seed->seq); // seedgen_init()
+  pcg32_advance_r(&gen, 2 * (uint64_t)run);      // skip earlier runs' seeds
+  *seed1 = pcg32_random_r(&gen);
+  *seed2 = pcg32_random_r(&gen);
+}
+
+static void run_rng(const mcrw_seed_t *seed, long run, pcg32_random_t *rng) {
+  uint32_t s1, s2;
+  mcrw_run_seeds(seed, run, &s1, &s2);
+  pcg32_srandom_r(rng, s1, s2); // myrand_init()
+}
+
+static void walk1d(pcg32_random_t *rng, long steps, int32_t *x) {
+  int32_t pos = 0;
+  for (long i = 0; i < steps; i++) {
+    pos += (pcg32_random_r(rng) > 0x80000000u) ? 1 : -1;
+    x[i] = pos;
+  }
+}
+
+static void walk2d(pcg32_random_t *rng, long steps, int32_t *x, int32_t *y) {
+  // dx, dy for the quarters +x, -x, +y, -y
+  static const int8_t dx[4] = {1, -1, 0, 0}, dy[4] = {0, 0, 1, -1};
+  int32_t px = 0, py = 0;
+  for (long i = 0; i < steps; i++) {
+    uint32_t q = pcg32_random_r(rng) >> 30;
+    px += dx[q];
+    py += dy[q];
+    x[i] = px;
+    y[i] = py;
+  }
+}
+
+void mcrw_walk1d(const mcrw_seed_t *seed, long run, long steps, int32_t *x) {
+  pcg32_random_t rng;
+  run_rng(seed, run, &rng);
+  walk1d(&rng, steps, x);
+}
+
+void mcrw_walk2d(const mcrw_seed_t *seed, long run, long steps, int32_t *x,
+                 int32_t *y) {
+  pcg32_random_t rng;
+  run_rng(seed, run, &rng);
+  walk2d(&rng, steps, x, y);
+}
+
+long mcrw_ensemble1d(const mcrw_ens_cfg_t *cfg, int32_t *x, exact_acc_t *x2,
+                     mcrw_run1d_fn fn, void *user) {
+  long done = 0;
+  for (long r = cfg->first_run; r < cfg->first_run + cfg->runs; r++) {
+    mcrw_walk1d(&cfg->seed, r, cfg->steps, x);
+    if (x2)
+      for (long i = 0; i < cfg->steps; i++)
+        exact_acc_add(&x2[i], (int64_t)x[i] * x[i]);
+    done++;
+    if (fn && fn(user, r, x, cfg->steps) != 0)
+      break;
+  }
+  return done;
+}
+
+long mcrw_ensemble2d(const mcrw_ens_cfg_t *cfg, int32_t *x, int32_t *y,
+                     exact_acc_t *acc_x, exact_acc_t *acc_y, mcrw_run2d_fn fn,
+                     void *user) {
+  long ts = cfg->t_sample;
+  int sample = (ts >= 1 && ts <= cfg->steps);
+  long done = 0;
+  for (long r = cfg->first_run; r < cfg->first_run + cfg->runs; r++) {
+    mcrw_walk2d(&cfg->seed, r, cfg->steps, x, y);
+    if (sample && acc_x)
+      exact_acc_add(acc_x, x[ts - 1]);
+    if (sample && acc_y)
+      exact_acc_add(acc_y, y[ts - 1]);
+    done++;
+    if (fn && fn(user, r, x, y, cfg->steps) != 0)
+      break;
+  }
+  return done;
+}
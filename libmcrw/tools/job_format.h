@@ -0,0 +1,69 @@
+/**
+ * @file job_format.h
+ * @brief Result lines of the libmcrw tools, in the programs' file formats
+ *
+ * mcrwd and mcrw_fork print their results exactly as program_dat
+ * (x2_mean.dat), program_2d (2d_ran_gen_t_*.dat) and program_diff (output
+ * file) write them, so make_plots.gp reads either source. Each function
+ * writes one line into out (at most JF_MAX_LINE bytes) and returns its
+ * length.
+ */
+
+#ifndef JOB_FORMAT_H
+#define JOB_FORMAT_H
+
+#include "../../common/include/fast_fmt.h"
+#include "../include/mcrw.h"
+
+#define JF_MAX_LINE 1024
+#define JF_LGAS_MEASUREMENTS 100 // measurements per sample, as program_diff
+
+// "t <x^2> err" ("%d %f %f")
+static inline size_t jf_x2_line(char *out, long t, const exact_acc_t *a) {
+  size_t n = fmt_i64(out, t);
+  out[n++] = ' ';
+  n += fmt_fixed(out + n, exact_acc_mean(a), 6);
+  out[n++] = ' ';
+  n += fmt_fixed(out + n, exact_acc_err(a), 6);
+  out[n++] = '\n';
+  return n;
+}
+
+// "run time step x y" of a 2D run sampled at time t
+static inline size_t jf_run2d_line(char *out, long run, long t, int64_t x,
+                                   int64_t y) {
+  const int64_t cols[5] = {run, t, t - 1, x, y};
+  size_t n = 0;
+  for (int i = 0; i < 5; i++) {
+    n += fmt_i64(out + n, cols[i]);
+    out[n++] = (i < 4) ? ' ' : '\n';
+  }
+  return n;
+}
+
+// The two comment lines heading a program_diff output file
+static inline size_t jf_lgas_header(char *out, long L, double rho,
+                                    long sweeps, long samples) {
+  return (size_t)snprintf(
+      out, JF_MAX_LINE,
+      "# L = %ld  rho_input = %.3f  num_sweeps = %ld    num_samples = %ld\n"
+      "# sweep   deltaR2_mean      D_t_mean        err_deltaR2\n",
+      L, rho, sweeps, samples);
+}
+
+// "sweep <dr2> D err_dr2 err_D" ("%ld %.12f %.12f %.12f %.12f")
+static inline size_t jf_lgas_line(char *out, long sweep,
+                                  const exact_ratio_t *a) {
+  double mean = exact_ratio_mean(a), err = exact_ratio_err(a);
+  const double cols[4] = {mean, mean / (4.0 * (double)sweep), err,
+                          err / (4.0 * (double)sweep)};
+  size_t n = fmt_i64(out, sweep);
+  for (int c = 0; c < 4; c++) {
+    out[n++] = ' ';
+    n += fmt_fixed(out + n, cols[c], 12);
+  }
+  out[n++] = '\n';
+  return n;
+}
+
+#endif // JOB_FORMAT_H
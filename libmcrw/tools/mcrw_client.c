@@ -0,0 +1,94 @@
+/**
+ * @file mcrw_client.c
+ * @brief Send one job to mcrwd and print its result on stdout
+ *
+ * Usage: mcrw_client [socket=path] kind [key=value ...]
+ *
+ *   mcrw_client lgas L=80 rho=0.6 sweeps=2000 samples=50 > out.dat
+ *
+ * The remaining arguments form the request line (see mcrwd.c). Exit status
+ * is 0 when the daemon answers "@ok"; an "@error" message goes to stderr.
+ */
+
+#include "../../common/include/cli_opts.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define MCRWD_SOCKET "/tmp/mcrwd.sock"
+#define MAX_REQUEST 1024
+
+static int write_all(int fd, const char *buf, size_t len) {
+  while (len > 0) {
+    ssize_t w = write(fd, buf, len);
+    if (w < 0 && errno == EINTR)
+      continue;
+    if (w <= 0)
+      return -1;
+    buf += w;
+    len -= (size_t)w;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  const char *path = opt_value(argc, argv, 1, "socket");
+  int first = path ? 2 : 1; // socket= must come first if given
+  if (!path)
+    path = MCRWD_SOCKET;
+  if (argc <= first) {
+    fprintf(stderr, "Usage: %s [socket=path] kind [key=value ...]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  char req[MAX_REQUEST];
+  size_t len = 0;
+  for (int i = first; i < argc; i++) {
+    size_t n = strlen(argv[i]);
+    if (len + n + 2 > sizeof(req)) {
+      fprintf(stderr, "request too long\n");
+      return EXIT_FAILURE;
+    }
+    memcpy(req + len, argv[i], n);
+    len += n;
+    req[len++] = (i + 1 < argc) ? ' ' : '\n';
+  }
+
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    perror(path);
+    return EXIT_FAILURE;
+  }
+  if (write_all(fd, req, len) != 0) {
+    perror("send");
+    return EXIT_FAILURE;
+  }
+
+  // copy the answer to stdout; the last line is the status
+  FILE *in = fdopen(fd, "r");
+  char *line = NULL;
+  size_t cap = 0;
+  ssize_t n;
+  int status = EXIT_FAILURE;
+  while ((n = getline(&line, &cap, in)) > 0) {
+    if (line[0] == '@') {
+      if (strcmp(line, "@ok\n") == 0)
+        status = EXIT_SUCCESS;
+      else
+        fprintf(stderr, "mcrwd: %s", line + 1);
+      break;
+    }
+    fwrite(line, 1, (size_t)n, stdout);
+  }
+  if (n <= 0)
+    fprintf(stderr, "mcrwd: connection closed without status\n");
+  free(line);
+  fclose(in);
+  return status;
+}
@@ -0,0 +1,487 @@
+/**
+ * @file mcrw_fork.c
+ * @brief Multi-process ensemble runner with accumulators in shared memory
+ *
+ * Usage: mcrw_fork kind [workers=n] [state=path] [key=value ...]
+ *
+ *   kind = ens1d (runs= steps= [first_run=]), ens2d (runs= steps= t=
+ *          [first_run=]) or lgas (L= rho= sweeps= samples=), plus
+ *          seed_state= / seed_seq= as for mcrwd
+ *
+ * The work is split into contiguous blocks of runs (samples for the
+ * lattice gas), one per forked worker. Each worker owns a slab of a shared
+ * mapping holding two copies of its exact accumulators: it accumulates
+ * privately, writes the spare copy, then publishes it by switching the
+ * `active` index, so the active copy is always a consistent state after a
+ * whole number of units. A worker killed by a signal or a crash therefore
+ * loses at most its uncommitted units; the launcher forks a replacement
+ * that resumes from the last commit (up to MAX_RESTARTS times) and the
+ * final result is the same as without the crash.
+ *
+ * Streams: walk run r always uses seed pair r of the seed stream (as the
+ * programs), so walk results do not depend on the number of workers.
+ * Lattice gas worker w draws its samples from stream w; with workers=1 the
+ * output equals program_diff.
+ *
+ * With state=path the mapping is a file: partial results survive the
+ * launcher itself, and running the same command again resumes the
+ * unfinished blocks. Workers die with the launcher (PR_SET_PDEATHSIG on
+ * Linux), and the launcher and its workers hold an exclusive flock on the
+ * file, so a resume waits until no process of an earlier run can still
+ * commit into it. Results are printed on stdout in the programs' file
+ * formats (see job_format.h).
+ */
+
+#include "../../common/include/cli_opts.h"
+#include "../include/mcrw.h"
+#include "job_format.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#define FORK_MAGIC "MCRWFRK1"
+#define PAGE 4096
+#define MAX_RESTARTS 3
+#define COMMIT_SECONDS 0.05 // a worker publishes its sums at least this often
+
+enum { JOB_ENS1D, JOB_ENS2D, JOB_LGAS };
+
+/**
+ * @brief Job description; also the header of the mapping (resume check)
+ */
+typedef struct {
+  char magic[8];
+  int32_t kind, workers;
+  int64_t runs, steps, t, first_run; // walks
+  int64_t L, sweeps, samples;        // lattice gas
+  double rho;
+  uint64_t seed_state, seed_seq;
+} fork_job_t;
+
+/**
+ * @brief Per-worker slab header, followed by two accumulator copies
+ */
+typedef struct {
+  _Atomic int32_t done;   // block finished
+  _Atomic int32_t active; // copy holding the last commit
+  int64_t begin, end;     // units [begin, end) of this block
+  int64_t units[2];       // units contained in each copy
+  mcrw_rng_t rng[2];      // lattice gas generator after those units
+} slab_t;
+
+typedef struct {
+  fork_job_t job;
+  size_t acc_bytes;  // one accumulator copy
+  size_t slab_bytes; // header + two copies, page aligned
+  size_t pos_off;    // ens2d: per-run positions int32[runs][2]
+  size_t slab_off;
+  size_t total;
+  char *map;
+  int fd; // state file (locked) or -1
+} layout_t;
+
+static size_t page_round(size_t n) { return (n + PAGE - 1) / PAGE * PAGE; }
+
+static slab_t *slab_of(const layout_t *l, int w) {
+  return (slab_t *)(l->map + l->slab_off + (size_t)w * l->slab_bytes);
+}
+
+static void *slab_copy(const layout_t *l, int w, int c) {
+  return (char *)slab_of(l, w) + page_round(sizeof(slab_t)) +
+         (size_t)c * l->acc_bytes;
+}
+
+static void layout_init(layout_t *l) {
+  const fork_job_t *j = &l->job;
+  if (j->kind == JOB_ENS1D)
+    l->acc_bytes = (size_t)j->steps * sizeof(exact_acc_t);
+  else if (j->kind == JOB_ENS2D)
+    l->acc_bytes = 2 * sizeof(exact_acc_t);
+  else
+    l->acc_bytes = JF_LGAS_MEASUREMENTS * sizeof(exact_ratio_t);
+  l->slab_bytes = page_round(sizeof(slab_t)) + 2 * page_round(l->acc_bytes);
+  l->acc_bytes = page_round(l->acc_bytes); // copies start on page boundaries
+  l->pos_off = page_round(sizeof(fork_job_t));
+  size_t pos_bytes =
+      (j->kind == JOB_ENS2D) ? (size_t)j->runs * 2 * sizeof(int32_t) : 0;
+  l->slab_off = l->pos_off + page_round(pos_bytes);
+  l->total = l->slab_off + (size_t)j->workers * l->slab_bytes;
+}
+
+/*============================================================================
+ * WORKER
+ *===========================================================================*/
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+// Publish the private sums: fill the spare copy, then flip `active`
+static void commit(const layout_t *l, int w, const void *acc, int64_t units,
+                   const mcrw_rng_t *rng) {
+  slab_t *s = slab_of(l, w);
+  int spare = 1 - atomic_load_explicit(&s->active, memory_order_relaxed);
+  memcpy(slab_copy(l, w, spare), acc, l->acc_bytes);
+  s->units[spare] = units;
+  if (rng)
+    s->rng[spare] = *rng;
+  atomic_store_explicit(&s->active, spare, memory_order_release);
+}
+
+static int worker_main(const layout_t *l, int w) {
+  const fork_job_t *j = &l->job;
+  slab_t *s = slab_of(l, w);
+  int c = atomic_load_explicit(&s->active, memory_order_acquire);
+  int64_t done = s->units[c]; // resume after the last commit
+  int64_t todo = s->end - s->begin;
+  mcrw_seed_t seed = {j->seed_state, j->seed_seq};
+
+  void *acc = malloc(l->acc_bytes);
+  int32_t *x = NULL, *y = NULL;
+  if (j->kind != JOB_LGAS) {
+    x = malloc((size_t)j->steps * sizeof(*x));
+    y = malloc((size_t)j->steps * sizeof(*y));
+  }
+  mcrw_lgas_t *g = NULL;
+  if (j->kind == JOB_LGAS) {
+    mcrw_lgas_cfg_t cfg = {j->L,       j->rho, j->sweeps, JF_LGAS_MEASUREMENTS,
+                           seed,       w};
+    g = mcrw_lgas_create(&cfg);
+    if (g && done > 0)
+      mcrw_lgas_set_rng(g, &s->rng[c]);
+  }
+  if (!acc || (j->kind != JOB_LGAS && (!x || !y)) ||
+      (j->kind == JOB_LGAS && !g))
+    return EXIT_FAILURE;
+  memcpy(acc, slab_copy(l, w, c), l->acc_bytes);
+
+  int32_t(*pos)[2] = (int32_t(*)[2])(l->map + l->pos_off);
+  double last = now_seconds();
+  while (done < todo) {
+    int64_t r = s->begin + done; // run (walks) or sample index in the block
+    mcrw_rng_t rng;
+    if (j->kind == JOB_ENS1D) {
+      exact_acc_t *x2 = acc;
+      mcrw_walk1d(&seed, j->first_run + r, j->steps, x);
+      for (int64_t i = 0; i < j->steps; i++)
+        exact_acc_add(&x2[i], (int64_t)x[i] * x[i]);
+    } else if (j->kind == JOB_ENS2D) {
+      exact_acc_t *axy = acc;
+      mcrw_walk2d(&seed, j->first_run + r, j->steps, x, y);
+      exact_acc_add(&axy[0], x[j->t - 1]);
+      exact_acc_add(&axy[1], y[j->t - 1]);
+      pos[r][0] = x[j->t - 1]; // visible once a commit covers run r
+      pos[r][1] = y[j->t - 1];
+    } else {
+      mcrw_lgas_sample(g, acc, NULL, NULL);
+      mcrw_lgas_get_rng(g, &rng);
+    }
+    done++;
+    if (done == todo || now_seconds() - last >= COMMIT_SECONDS) {
+      commit(l, w, acc, done, j->kind == JOB_LGAS ? &rng : NULL);
+      last = now_seconds();
+    }
+  }
+  atomic_store_explicit(&s->done, 1, memory_order_release);
+  return EXIT_SUCCESS;
+}
+
+static pid_t spawn(const layout_t *l, int w) {
+  fflush(stdout);
+  pid_t launcher = getpid();
+  pid_t pid = fork();
+  if (pid == 0) {
+#ifdef __linux__
+    // a worker must not outlive the launcher: a second launcher resuming
+    // the state file would fork another worker for the same slab
+    if (prctl(PR_SET_PDEATHSIG, SIGKILL) != 0 || getppid() != launcher)
+      _exit(EXIT_FAILURE);
+#endif
+    _exit(worker_main(l, w));
+  }
+  return pid;
+}
+
+/*============================================================================
+ * LAUNCHER
+ *===========================================================================*/
+
+static int parse_job(int argc, char **argv, fork_job_t *j) {
+  static const char *const keys[] = {
+      "workers", "state", "runs",  "steps",   "t",          "first_run",
+      "L",       "rho",   "sweeps", "samples", "seed_state", "seed_seq",
+      NULL};
+  if (!opt_check(argc, argv, 2, keys))
+    return -1;
+  memset(j, 0, sizeof(*j));
+  memcpy(j->magic, FORK_MAGIC, sizeof(j->magic));
+  if (strcmp(argv[1], "ens1d") == 0)
+    j->kind = JOB_ENS1D;
+  else if (strcmp(argv[1], "ens2d") == 0)
+    j->kind = JOB_ENS2D;
+  else if (strcmp(argv[1], "lgas") == 0)
+    j->kind = JOB_LGAS;
+  else
+    return -1;
+  j->workers = (int32_t)opt_long(argc, argv, 2, "workers",
+                                 sysconf(_SC_NPROCESSORS_ONLN));
+  j->runs = opt_long(argc, argv, 2, "runs", 0);
+  j->steps = opt_long(argc, argv, 2, "steps", 0);
+  j->t = opt_long(argc, argv, 2, "t", 0);
+  j->first_run = opt_long(argc, argv, 2, "first_run", 0);
+  j->L = opt_long(argc, argv, 2, "L", 0);
+  j->rho = opt_double(argc, argv, 2, "rho", 0.0);
+  j->sweeps = opt_long(argc, argv, 2, "sweeps", 0);
+  j->samples = opt_long(argc, argv, 2, "samples", 0);
+  const char *v;
+  j->seed_state = (v = opt_value(argc, argv, 2, "seed_state"))
+                      ? strtoull(v, NULL, 10)
+                      : MCRW_SEED_DEFAULT.state;
+  j->seed_seq = (v = opt_value(argc, argv, 2, "seed_seq"))
+                    ? strtoull(v, NULL, 10)
+                    : MCRW_SEED_DEFAULT.seq;
+
+  if (j->kind == JOB_LGAS) {
+    mcrw_lgas_cfg_t cfg = {j->L, j->rho, j->sweeps, JF_LGAS_MEASUREMENTS,
+                           MCRW_SEED_DEFAULT, 0};
+    mcrw_lgas_t *g = mcrw_lgas_create(&cfg); // validates the parameters
+    if (!g || j->samples <= 0)
+      return -1;
+    mcrw_lgas_destroy(g);
+  } else if (j->runs <= 0 || j->steps <= 0 || j->first_run < 0 ||
+             (j->kind == JOB_ENS2D && (j->t < 1 || j->t > j->steps))) {
+    return -1;
+  }
+  int64_t units = (j->kind == JOB_LGAS) ? j->samples : j->runs;
+  if (j->workers < 1)
+    j->workers = 1;
+  if (j->workers > units)
+    j->workers = (int32_t)units;
+  return 0;
+}
+
+// Map the state (file or anonymous); returns 1 when resuming a file
+static int map_state(layout_t *l, const char *path) {
+  l->fd = -1;
+  if (!path) {
+    l->map = mmap(NULL, l->total, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return (l->map == MAP_FAILED) ? -1 : 0;
+  }
+  int fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0)
+    return -1;
+  // held until the launcher exits; the workers share it through the fd
+  int locked = flock(fd, LOCK_EX | LOCK_NB) == 0;
+  if (!locked && errno == EWOULDBLOCK) {
+    fprintf(stderr, "mcrw_fork: %s is in use, waiting\n", path);
+    do
+      locked = flock(fd, LOCK_EX) == 0;
+    while (!locked && errno == EINTR);
+  }
+  if (!locked) {
+    close(fd);
+    return -1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return -1;
+  }
+  int resume = 0;
+  if ((size_t)st.st_size == l->total) {
+    fork_job_t old;
+    resume = pread(fd, &old, sizeof(old), 0) == (ssize_t)sizeof(old) &&
+             memcmp(&old, &l->job, sizeof(old)) == 0;
+  }
+  if (!resume && (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)l->total))) {
+    close(fd);
+    return -1; // fresh file: zero filled
+  }
+  l->map = mmap(NULL, l->total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (l->map == MAP_FAILED) {
+    close(fd);
+    return -1;
+  }
+  l->fd = fd;
+  return resume;
+}
+
+static void print_results(const layout_t *l, int64_t *units_done) {
+  const fork_job_t *j = &l->job;
+  int W = j->workers;
+  char line[JF_MAX_LINE];
+  *units_done = 0;
+
+  if (j->kind == JOB_ENS2D) { // per-run lines in run order
+    const int32_t(*pos)[2] = (const int32_t(*)[2])(l->map + l->pos_off);
+    for (int w = 0; w < W; w++) {
+      slab_t *s = slab_of(l, w);
+      int c = atomic_load_explicit(&s->active, memory_order_acquire);
+      for (int64_t r = s->begin; r < s->begin + s->units[c]; r++)
+        fwrite(line, 1,
+               jf_run2d_line(line, j->first_run + r, j->t, pos[r][0],
+                             pos[r][1]),
+               stdout);
+      *units_done += s->units[c];
+    }
+    return;
+  }
+
+  // integer sums: merging the committed copies in any order is exact
+  void *total = calloc(1, l->acc_bytes);
+  if (!total)
+    return;
+  for (int w = 0; w < W; w++) {
+    slab_t *s = slab_of(l, w);
+    int c = atomic_load_explicit(&s->active, memory_order_acquire);
+    const void *src = slab_copy(l, w, c);
+    if (j->kind == JOB_ENS1D)
+      for (int64_t i = 0; i < j->steps; i++)
+        exact_acc_merge((exact_acc_t *)total + i, (const exact_acc_t *)src + i);
+    else
+      for (int m = 0; m < JF_LGAS_MEASUREMENTS; m++)
+        exact_ratio_merge((exact_ratio_t *)total + m,
+                          (const exact_ratio_t *)src + m);
+    *units_done += s->units[c];
+  }
+  if (j->kind == JOB_ENS1D) {
+    for (int64_t t = 0; t < j->steps; t++)
+      fwrite(line, 1, jf_x2_line(line, t, (exact_acc_t *)total + t), stdout);
+  } else {
+    fwrite(line, 1,
+           jf_lgas_header(line, j->L, j->rho, j->sweeps, *units_done),
+           stdout);
+    long period = j->sweeps / JF_LGAS_MEASUREMENTS;
+    for (int m = 0; m < JF_LGAS_MEASUREMENTS; m++)
+      fwrite(line, 1,
+             jf_lgas_line(line, (m + 1) * period, (exact_ratio_t *)total + m),
+             stdout);
+  }
+  free(total);
+}
+
+int main(int argc, char **argv) {
+  layout_t l = {0};
+  if (argc < 2 || parse_job(argc, argv, &l.job) != 0) {
+    fprintf(stderr,
+            "Usage: %s ens1d|ens2d|lgas [workers=n] [state=path] "
+            "[key=value ...]\n"
+            "  ens1d runs= steps= [first_run=]\n"
+            "  ens2d runs= steps= t= [first_run=]\n"
+            "  lgas  L= rho= sweeps= (multiple of 100) samples=\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+  fork_job_t *j = &l.job;
+  layout_init(&l);
+  const char *path = opt_value(argc, argv, 2, "state");
+  int resume = map_state(&l, path);
+  if (resume < 0) {
+    perror(path ? path : "mmap");
+    return EXIT_FAILURE;
+  }
+
+  int W = j->workers;
+  int64_t units = (j->kind == JOB_LGAS) ? j->samples : j->runs;
+  if (!resume) {
+    memcpy(l.map, j, sizeof(*j));
+    for (int w = 0; w < W; w++) { // contiguous blocks, sizes differ by <= 1
+      slab_of(&l, w)->begin = units * w / W;
+      slab_of(&l, w)->end = units * (w + 1) / W;
+    }
+  } else {
+    fprintf(stderr, "mcrw_fork: resuming %s\n", path);
+  }
+
+  pid_t *pids = calloc((size_t)W, sizeof(*pids));
+  int *restarts = calloc((size_t)W, sizeof(*restarts));
+  if (!pids || !restarts) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    return EXIT_FAILURE;
+  }
+  int running = 0;
+  for (int w = 0; w < W; w++) {
+    if (atomic_load(&slab_of(&l, w)->done))
+      continue; // finished in an earlier invocation
+    pids[w] = spawn(&l, w);
+    if (pids[w] < 0) {
+      perror("fork");
+      return EXIT_FAILURE;
+    }
+    running++;
+  }
+
+  int failed = 0;
+  while (running > 0) {
+    int status;
+    pid_t pid = wait(&status);
+    if (pid < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    int w = 0;
+    while (w < W && pids[w] != pid)
+      w++;
+    if (w == W)
+      continue;
+    running--;
+    pids[w] = 0;
+    slab_t *s = slab_of(&l, w);
+    if (atomic_load(&s->done))
+      continue;
+
+    int64_t kept = s->units[atomic_load(&s->active)];
+    if (WIFSIGNALED(status))
+      fprintf(stderr, "mcrw_fork: worker %d killed by signal %d", w,
+              WTERMSIG(status));
+    else
+      fprintf(stderr, "mcrw_fork: worker %d exited with status %d", w,
+              WEXITSTATUS(status));
+    if (restarts[w] < MAX_RESTARTS) {
+      restarts[w]++;
+      fprintf(stderr, ", restarting after unit %ld of %ld\n", (long)kept,
+              (long)(s->end - s->begin));
+      pids[w] = spawn(&l, w);
+      if (pids[w] > 0)
+        running++;
+    } else {
+      fprintf(stderr, ", giving up (%ld of %ld units kept)\n", (long)kept,
+              (long)(s->end - s->begin));
+      failed = 1;
+    }
+  }
+
+  int64_t units_done;
+  print_results(&l, &units_done);
+  if (units_done < units) {
+    fprintf(stderr, "mcrw_fork: incomplete ensemble, %ld of %ld units\n",
+            (long)units_done, (long)units);
+    failed = 1;
+  }
+  if (path)
+    msync(l.map, l.total, MS_SYNC);
+  munmap(l.map, l.total);
+  if (l.fd >= 0)
+    close(l.fd); // releases the lock
+  free(pids);
+  free(restarts);
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,427 @@
+/**
+ * @file mcrwd.c
+ * @brief Simulation daemon: runs libmcrw jobs received on a Unix socket
+ *
+ * Usage: mcrwd [socket=path] [threads=n] [max_steps=n] [max_L=n]
+ *
+ * A pool of worker threads stays up with its trajectory buffers,
+ * accumulators and lattice allocated, so a job costs neither process
+ * startup nor allocation. One connection carries one job: a single request
+ * line of "kind key=value ..." tokens, answered with the result lines and a
+ * final status line "@ok" or "@error <message>".
+ *
+ *   ens1d runs=R steps=T [first_run=r]      -> x2_mean.dat lines
+ *   ens2d runs=R steps=T t=t [first_run=r]  -> 2d_ran_gen_t_*.dat lines
+ *   lgas L=L rho=p sweeps=S samples=N       -> program_diff output file
+ *   ping | shutdown
+ *
+ * Every job also accepts seed_state= and seed_seq= (default: the programs'
+ * seeding), so results are those of the corresponding program. The answer
+ * is written as it is produced; mcrw_client prints it on stdout.
+ */
+
+#include "../../common/include/cli_opts.h"
+#include "../include/mcrw.h"
+#include "job_format.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define MCRWD_SOCKET "/tmp/mcrwd.sock"
+#define MAX_REQUEST 1024 // request line length
+#define MAX_TOKENS 32
+#define QUEUE_LEN 256      // pending connections
+#define REPLY_BYTES (1u << 16)
+#define LGAS_MEASUREMENTS JF_LGAS_MEASUREMENTS
+
+/*============================================================================
+ * REPLY BUFFER
+ *===========================================================================*/
+
+typedef struct {
+  int fd, error;
+  size_t used;
+  char buf[REPLY_BYTES];
+} reply_t;
+
+static void reply_flush(reply_t *r) {
+  size_t off = 0;
+  while (!r->error && off < r->used) {
+    ssize_t w = write(r->fd, r->buf + off, r->used - off);
+    if (w < 0 && errno == EINTR)
+      continue;
+    if (w <= 0)
+      r->error = 1; // client went away: the job keeps its result to itself
+    else
+      off += (size_t)w;
+  }
+  r->used = 0;
+}
+
+// Room for one more line of at most JF_MAX_LINE bytes
+static char *reply_line(reply_t *r) {
+  if (r->used + JF_MAX_LINE > REPLY_BYTES)
+    reply_flush(r);
+  return r->buf + r->used;
+}
+
+static void reply_text(reply_t *r, const char *s) {
+  size_t n = strlen(s);
+  memcpy(reply_line(r), s, n);
+  r->used += n;
+}
+
+/*============================================================================
+ * WORKERS
+ *===========================================================================*/
+
+/**
+ * @brief Buffers a worker keeps across jobs (grown, never shrunk)
+ */
+typedef struct {
+  long steps_cap;
+  int32_t *x, *y;
+  exact_acc_t *x2;
+  exact_ratio_t racc[LGAS_MEASUREMENTS];
+  mcrw_lgas_t *lgas;
+  reply_t reply;
+} worker_t;
+
+static int worker_reserve(worker_t *w, long steps) {
+  if (steps <= w->steps_cap)
+    return 0;
+  int32_t *x = realloc(w->x, (size_t)steps * sizeof(*x));
+  if (x)
+    w->x = x;
+  int32_t *y = realloc(w->y, (size_t)steps * sizeof(*y));
+  if (y)
+    w->y = y;
+  exact_acc_t *x2 = realloc(w->x2, (size_t)steps * sizeof(*x2));
+  if (x2)
+    w->x2 = x2;
+  if (!x || !y || !x2)
+    return -1;
+  w->steps_cap = steps;
+  return 0;
+}
+
+static void worker_free(worker_t *w) {
+  free(w->x);
+  free(w->y);
+  free(w->x2);
+  mcrw_lgas_destroy(w->lgas);
+}
+
+static mcrw_seed_t job_seed(int argc, char **argv) {
+  mcrw_seed_t s = MCRW_SEED_DEFAULT;
+  const char *v;
+  if ((v = opt_value(argc, argv, 1, "seed_state")))
+    s.state = strtoull(v, NULL, 10);
+  if ((v = opt_value(argc, argv, 1, "seed_seq")))
+    s.seq = strtoull(v, NULL, 10);
+  return s;
+}
+
+static const char *job_ens1d(worker_t *w, int argc, char **argv) {
+  static const char *const keys[] = {"runs", "steps", "first_run",
+                                     "seed_state", "seed_seq", NULL};
+  if (!opt_check(argc, argv, 1, keys))
+    return "unknown option";
+  mcrw_ens_cfg_t cfg = {job_seed(argc, argv),
+                        opt_long(argc, argv, 1, "first_run", 0),
+                        opt_long(argc, argv, 1, "runs", 0),
+                        opt_long(argc, argv, 1, "steps", 0), 0};
+  if (cfg.runs <= 0 || cfg.steps <= 0 || cfg.first_run < 0)
+    return "runs and steps must be positive";
+  if (worker_reserve(w, cfg.steps) != 0)
+    return "out of memory";
+
+  memset(w->x2, 0, (size_t)cfg.steps * sizeof(*w->x2));
+  mcrw_ensemble1d(&cfg, w->x, w->x2, NULL, NULL);
+  for (long t = 0; t < cfg.steps; t++)
+    w->reply.used += jf_x2_line(reply_line(&w->reply), t, &w->x2[t]);
+  return NULL;
+}
+
+typedef struct {
+  reply_t *reply;
+  long t;
+} ens2d_ctx_t;
+
+// "run time step x y" line of the run at time t, as program_2d
+static int ens2d_line(void *user, long run, const int32_t *x, const int32_t *y,
+                      long steps) {
+  (void)steps;
+  ens2d_ctx_t *c = user;
+  c->reply->used += jf_run2d_line(reply_line(c->reply), run, c->t,
+                                  x[c->t - 1], y[c->t - 1]);
+  return c->reply->error; // stop if the client is gone
+}
+
+static const char *job_ens2d(worker_t *w, int argc, char **argv) {
+  static const char *const keys[] = {"runs",       "steps",    "t", "first_run",
+                                     "seed_state", "seed_seq", NULL};
+  if (!opt_check(argc, argv, 1, keys))
+    return "unknown option";
+  mcrw_ens_cfg_t cfg = {job_seed(argc, argv),
+                        opt_long(argc, argv, 1, "first_run", 0),
+                        opt_long(argc, argv, 1, "runs", 0),
+                        opt_long(argc, argv, 1, "steps", 0),
+                        opt_long(argc, argv, 1, "t", 0)};
+  if (cfg.runs <= 0 || cfg.steps <= 0 || cfg.first_run < 0)
+    return "runs and steps must be positive";
+  if (cfg.t_sample < 1 || cfg.t_sample > cfg.steps)
+    return "t must be in [1, steps]";
+  if (worker_reserve(w, cfg.steps) != 0)
+    return "out of memory";
+
+  ens2d_ctx_t ctx = {&w->reply, cfg.t_sample};
+  mcrw_ensemble2d(&cfg, w->x, w->y, NULL, NULL, ens2d_line, &ctx);
+  return NULL;
+}
+
+static const char *job_lgas(worker_t *w, int argc, char **argv) {
+  static const char *const keys[] = {"L",          "rho",      "sweeps",
+                                     "samples",    "seed_state", "seed_seq",
+                                     NULL};
+  if (!opt_check(argc, argv, 1, keys))
+    return "unknown option";
+  mcrw_lgas_cfg_t cfg = {opt_long(argc, argv, 1, "L", 0),
+                         opt_double(argc, argv, 1, "rho", 0.0),
+                         opt_long(argc, argv, 1, "sweeps", 0),
+                         LGAS_MEASUREMENTS, job_seed(argc, argv), 0};
+  long samples = opt_long(argc, argv, 1, "samples", 0);
+  if (samples <= 0)
+    return "samples must be positive";
+
+  // keep the worker's lattice unless this one is larger
+  if (!w->lgas || mcrw_lgas_reset(w->lgas, &cfg) != 0) {
+    mcrw_lgas_destroy(w->lgas);
+    w->lgas = mcrw_lgas_create(&cfg);
+    if (!w->lgas)
+      return "invalid lattice gas parameters (or out of memory)";
+  }
+
+  memset(w->racc, 0, sizeof(w->racc));
+  for (long s = 0; s < samples; s++)
+    mcrw_lgas_sample(w->lgas, w->racc, NULL, NULL);
+
+  w->reply.used += jf_lgas_header(reply_line(&w->reply), cfg.L, cfg.rho,
+                                  cfg.num_sweeps, samples);
+  long period = cfg.num_sweeps / LGAS_MEASUREMENTS;
+  for (long m = 0; m < LGAS_MEASUREMENTS; m++)
+    w->reply.used +=
+        jf_lgas_line(reply_line(&w->reply), (m + 1) * period, &w->racc[m]);
+  return NULL;
+}
+
+/*============================================================================
+ * CONNECTIONS
+ *===========================================================================*/
+
+static int listen_fd = -1;
+static atomic_int stopping;
+
+static struct {
+  pthread_mutex_t lock;
+  pthread_cond_t ready;
+  int fds[QUEUE_LEN];
+  int head, count, closed;
+} queue = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, {0}, 0, 0, 0};
+
+// Read the request line; returns its length or -1
+static int read_request(int fd, char *line) {
+  int len = 0;
+  while (len < MAX_REQUEST - 1) {
+    ssize_t r = read(fd, line + len, (size_t)(MAX_REQUEST - 1 - len));
+    if (r < 0 && errno == EINTR)
+      continue;
+    if (r <= 0)
+      break;
+    len += (int)r;
+    if (memchr(line, '\n', (size_t)len))
+      break;
+  }
+  line[len] = '\0';
+  char *nl = strchr(line, '\n');
+  if (!nl)
+    return -1;
+  *nl = '\0';
+  return (int)(nl - line);
+}
+
+static void serve(worker_t *w, int fd) {
+  char line[MAX_REQUEST];
+  char *argv[MAX_TOKENS];
+  int argc = 0;
+  w->reply.fd = fd;
+  w->reply.error = 0;
+  w->reply.used = 0;
+
+  const char *err = NULL;
+  if (read_request(fd, line) < 0) {
+    err = "request line missing or too long";
+  } else {
+    char *save;
+    for (char *tok = strtok_r(line, " \t\r", &save); tok && argc < MAX_TOKENS;
+         tok = strtok_r(NULL, " \t\r", &save))
+      argv[argc++] = tok;
+    if (argc == 0)
+      err = "empty request";
+    else if (strcmp(argv[0], "ens1d") == 0)
+      err = job_ens1d(w, argc, argv);
+    else if (strcmp(argv[0], "ens2d") == 0)
+      err = job_ens2d(w, argc, argv);
+    else if (strcmp(argv[0], "lgas") == 0)
+      err = job_lgas(w, argc, argv);
+    else if (strcmp(argv[0], "ping") == 0)
+      err = NULL;
+    else if (strcmp(argv[0], "shutdown") == 0) {
+      atomic_store(&stopping, 1);
+      shutdown(listen_fd, SHUT_RDWR); // wakes the accept loop
+    } else
+      err = "unknown job kind";
+  }
+
+  if (err) {
+    reply_text(&w->reply, "@error ");
+    reply_text(&w->reply, err);
+    reply_text(&w->reply, "\n");
+  } else {
+    reply_text(&w->reply, "@ok\n");
+  }
+  reply_flush(&w->reply);
+  close(fd);
+}
+
+static void *worker_main(void *arg) {
+  worker_t *w = arg;
+  for (;;) {
+    pthread_mutex_lock(&queue.lock);
+    while (queue.count == 0 && !queue.closed)
+      pthread_cond_wait(&queue.ready, &queue.lock);
+    if (queue.count == 0) { // closed and drained
+      pthread_mutex_unlock(&queue.lock);
+      return NULL;
+    }
+    int fd = queue.fds[queue.head];
+    queue.head = (queue.head + 1) % QUEUE_LEN;
+    queue.count--;
+    pthread_mutex_unlock(&queue.lock);
+    serve(w, fd);
+  }
+}
+
+int main(int argc, char **argv) {
+  static const char *const options[] = {"socket", "threads", "max_steps",
+                                        "max_L", NULL};
+  if (!opt_check(argc, argv, 1, options)) {
+    fprintf(stderr,
+            "Usage: %s [socket=path] [threads=n] [max_steps=n] [max_L=n]\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+  const char *path = opt_value(argc, argv, 1, "socket");
+  if (!path)
+    path = MCRWD_SOCKET;
+  long nthreads = opt_long(argc, argv, 1, "threads", sysconf(_SC_NPROCESSORS_ONLN));
+  long max_steps = opt_long(argc, argv, 1, "max_steps", 100000);
+  long max_L = opt_long(argc, argv, 1, "max_L", 80);
+  if (nthreads < 1)
+    nthreads = 1;
+
+  signal(SIGPIPE, SIG_IGN); // a vanished client is a write error, not a kill
+
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "socket path too long: %s\n", path);
+    return EXIT_FAILURE;
+  }
+  strcpy(addr.sun_path, path);
+  listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(path);
+  if (listen_fd < 0 || bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+      listen(listen_fd, QUEUE_LEN) != 0) {
+    perror(path);
+    return EXIT_FAILURE;
+  }
+
+  // warm pool: buffers for max_steps and a max_L lattice per worker
+  worker_t *workers = calloc((size_t)nthreads, sizeof(*workers));
+  pthread_t *tids = calloc((size_t)nthreads, sizeof(*tids));
+  if (!workers || !tids) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    return EXIT_FAILURE;
+  }
+  mcrw_lgas_cfg_t warm = {max_L, 0.5, LGAS_MEASUREMENTS, LGAS_MEASUREMENTS,
+                          MCRW_SEED_DEFAULT, 0};
+  long started = 0;
+  for (; started < nthreads; started++) {
+    worker_t *w = &workers[started];
+    if (worker_reserve(w, max_steps) != 0 ||
+        !(w->lgas = mcrw_lgas_create(&warm))) {
+      fprintf(stderr, "Memory allocation failed (worker %ld).\n", started);
+      break;
+    }
+    int err = pthread_create(&tids[started], NULL, worker_main, w);
+    if (err != 0) {
+      fprintf(stderr, "Cannot create worker thread %ld: %s\n", started,
+              strerror(err));
+      break;
+    }
+  }
+  if (started < nthreads) { // serve with the workers that did start
+    worker_free(&workers[started]);
+    nthreads = started;
+  }
+  if (nthreads == 0) {
+    free(workers);
+    free(tids);
+    close(listen_fd);
+    unlink(path);
+    return EXIT_FAILURE;
+  }
+  printf("mcrwd: listening on %s with %ld workers\n", path, nthreads);
+  fflush(stdout);
+
+  while (!atomic_load(&stopping)) {
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      break; // listening socket shut down
+    }
+    pthread_mutex_lock(&queue.lock);
+    if (queue.count == QUEUE_LEN) {
+      pthread_mutex_unlock(&queue.lock);
+      close(fd); // overloaded: client sees a closed connection
+      continue;
+    }
+    queue.fds[(queue.head + queue.count) % QUEUE_LEN] = fd;
+    queue.count++;
+    pthread_cond_signal(&queue.ready);
+    pthread_mutex_unlock(&queue.lock);
+  }
+
+  // finish the queued jobs, then exit
+  pthread_mutex_lock(&queue.lock);
+  queue.closed = 1;
+  pthread_cond_broadcast(&queue.ready);
+  pthread_mutex_unlock(&queue.lock);
+  for (long i = 0; i < nthreads; i++) {
+    pthread_join(tids[i], NULL);
+    worker_free(&workers[i]);
+  }
+  free(workers);
+  free(tids);
+  close(listen_fd);
+  unlink(path);
+  return EXIT_SUCCESS;
+}
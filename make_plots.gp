@@ -51,7 +51,8 @@ set ylabel "x_2(t)"
 unset logscale
 set size ratio -1
 set xtics rotate by -45
-plot "02_2d_random_walk/results/dat/traj_1M.dat" using 2:3 with lines ls 5 title "Trajectory"
+# decimated trace written by the program: int32 triples (t, x1, x2)
+plot "02_2d_random_walk/results/dat/traj_1M_dec.bin" binary format="%int32%int32%int32" using 2:3 with lines ls 5 title "Trajectory"
 
 # Plot 5: 2D RW P(x) histogram with gaussian fit
 set terminal pngcairo size 1400,1155 enhanced font 'Arial,24' rounded
@@ -63,25 +64,18 @@ set xlabel "x_1"
 set ylabel "P(x_1(t))"
 unset logscale
 set xrange [-800:800]
-bin_width(x, s) = s*floor(x/s)
-N = 10000.0
 
 # Define Gaussians for 2D walk x_1 variance is t/2.
-# But lattice walks have probability on either even or odd sites, so density is scaled.
-# We'll just plot them normalized nicely by bin width.
-# width depends on t to look nice:
-w1000 = 8.0
-w10000 = 25.0
-w100000 = 80.0
-
+# P_x1_<t>.dat is already binned (left bin edge) and normalized by the
+# program, bin widths 8, 25, 80 (see generate_data.sh).
 P(x, t) = (1.0/sqrt(pi*t)) * exp(-(x**2)/t)
 
 plot \
-    "02_2d_random_walk/results/dat/res_100000.dat" using (bin_width($4, w100000)):(1.0/(N*w100000)) smooth freq with points ls 1 ps 1.5 title "t=10^5", \
+    "02_2d_random_walk/results/dat/P_x1_100000.dat" using 1:2 with points ls 1 ps 1.5 title "t=10^5", \
     P(x, 100000.0) with lines lw 3.0 dt 1 lc rgb "#333333" notitle, \
-    "02_2d_random_walk/results/dat/res_10000.dat" using (bin_width($4, w10000)):(1.0/(N*w10000)) smooth freq with points ls 3 ps 1.5 title "t=10^4", \
+    "02_2d_random_walk/results/dat/P_x1_10000.dat" using 1:2 with points ls 3 ps 1.5 title "t=10^4", \
     P(x, 10000.0) with lines lw 3.0 dt 4 lc rgb "#333333" notitle, \
-    "02_2d_random_walk/results/dat/res_1000.dat" using (bin_width($4, w1000)):(1.0/(N*w1000)) smooth freq with points ls 4 ps 1.5 title "t=10^3", \
+    "02_2d_random_walk/results/dat/P_x1_1000.dat" using 1:2 with points ls 4 ps 1.5 title "t=10^3", \
     P(x, 1000.0) with lines lw 3.0 dt 3 lc rgb "#333333" notitle
 
 # Plot 6: 2D RW P(x1, x2) 3D plot
@@ -103,11 +97,13 @@ set view 55, 30, 1.15, 1.15
 set xyplane relative 0.375
 # Theoretical surface:
 G(x,y) = (1.0/(pi*100000.0)) * exp(-(x**2 + y**2)/100000.0)
+# Numerical density on the program's grid (float32 binary matrix, empty
+# cells skipped)
 splot \
     G(x,y) with lines lc rgb "#333333" title "Theoretical Gaussian Limit", \
-    "02_2d_random_walk/results/dat/res_100000.dat" every 2 using 4:5:(G($4,$5)) with impulses lw 1 lc rgb "#B121EF" notitle, \
-    "" every 2 using 4:5:(G($4,$5)) with points pt 7 ps 1.2 lc rgb "#B121EF" title "Numerical Data", \
-    "" every 2 using 4:5:(G($4,$5)) with points pt 6 ps 1.2 lw 0.5 lc rgb "black" notitle
+    "02_2d_random_walk/results/dat/P_x1x2_100000.bin" binary matrix using 1:2:($3 > 0 ? $3 : 1/0) with impulses lw 1 lc rgb "#B121EF" notitle, \
+    "" binary matrix using 1:2:($3 > 0 ? $3 : 1/0) with points pt 7 ps 1.2 lc rgb "#B121EF" title "Numerical Data", \
+    "" binary matrix using 1:2:($3 > 0 ? $3 : 1/0) with points pt 6 ps 1.2 lw 0.5 lc rgb "black" notitle
 
 # Plot 7: Diffusion Coefficient (rho variation)
 set terminal pngcairo size 1400,1155 enhanced font 'Arial,24' rounded
@@ -149,3 +145,162 @@ plot \
     "03_diffusion_coefficient/results/out_rho0.6_L40.dat" using 1:3:5 with yerrorbars ls 3 ps 1.5 title "L=40", \
     "03_diffusion_coefficient/results/out_rho0.6_L80.dat" using 1:3:5 with yerrorbars ls 4 ps 1.5 title "L=80"
 
+# Plot 9: SCGF of the displacement by cloning vs exact result
+set output 'plots/plot9_ld_scgf.png'
+# set title "Scaled cumulant generating function {/Symbol l}(s)"
+set xlabel "s"
+set ylabel "{/Symbol l}(s)"
+unset logscale
+set xrange [-2:2]
+set yrange [0:1.4]
+set xtics -2, 0.5, 2
+set ytics 0, 0.2, 1.4
+plot \
+    "04_large_deviations/results/dat/ld_1d_scgf.dat" using 1:2:3 with yerrorbars ls 1 ps 1.5 title "1D cloning", \
+    log(cosh(x)) with lines lw 3.0 dt 1 lc rgb "#333333" title "log cosh s", \
+    "04_large_deviations/results/dat/ld_2d_scgf.dat" using 1:2:3 with yerrorbars ls 4 ps 1.5 title "2D cloning", \
+    log((1 + cosh(x)) / 2) with lines lw 3.0 dt 4 lc rgb "#333333" title "log((1+cosh s)/2)"
+
+# Plot 10: tails of P(x1) at t = 1000 reweighted from the biased populations
+set output 'plots/plot10_ld_tail.png'
+# set title "log_{10} P(x_1(t)) for t = 1000 in 2D RW"
+set xlabel "x_1"
+set ylabel "log_{10} P(x_1(t))"
+set xrange [-1000:1000]
+set yrange [*:0]
+set xtics -1000, 500, 1000
+set ytics auto
+plot \
+    for [i=0:20] "04_large_deviations/results/dat/ld_2d_tail.dat" index i using 1:2 with points ls 1 ps 0.8 notitle, \
+    "04_large_deviations/results/dat/ld_2d_tail.dat" using 1:4 with lines lw 2.0 lc rgb "#333333" title "exact"
+
+# Plot 11: survival probability S(t) up to first passage
+set output 'plots/plot11_fpt_survival.png'
+# set title "Survival probability S(t)"
+set xlabel "t"
+set ylabel "S(t)"
+set logscale xy
+set xrange [1:1e6]
+set yrange [1e-4:1.1]
+set xtics auto
+set ytics auto
+set format x "10^{%L}"
+set format y "10^{%L}"
+plot \
+    "05_first_passage/results/dat/fpt_1d_point_surv.dat" using 1:2 with points ls 1 ps 1.5 title "1D, a=10", \
+    "05_first_passage/results/dat/fpt_1d_point_surv.dat" using 1:4 with lines lw 3.0 lc rgb "#333333" title "exact", \
+    "05_first_passage/results/dat/fpt_2d_line_surv.dat" using 1:2 with points ls 3 ps 1.5 title "2D, line x_1=10", \
+    "05_first_passage/results/dat/fpt_2d_box_surv.dat" using 1:2 with points ls 4 ps 1.5 title "2D, box L=50"
+unset format
+
+# Plot 12: SAW end-to-end distance from the pivot algorithm
+set output 'plots/plot12_saw_R2.png'
+# set title "<R^2(N)> / N^{3/2}"
+set xlabel "N"
+set ylabel "<R^2(N)> / N^{3/2}"
+set logscale x
+unset logscale y
+set xrange [5:5e4]
+set yrange [0.7:0.9]
+set xtics auto
+set ytics auto
+set format x "10^{%L}"
+plot \
+    "06_self_avoiding_walk/results/dat/saw_R2.dat" using 1:6:($3/$1**1.5) with yerrorbars ls 1 ps 1.5 title "pivot", \
+    0.771 with lines lw 3.0 lc rgb "#333333" title "N -> oo"
+unset format
+
+# Plot 13: 1D continuous-time random walk, <x^2(t)> at wall times t
+set output 'plots/plot13_ctrw_x2.png'
+# set title "CTRW {/Symbol \341}x^2(t){/Symbol \361}"
+set xlabel "Time t"
+set ylabel "{/Symbol \341}x^2(t){/Symbol \361}"
+set logscale xy
+set xrange [1:1e5]
+set yrange [0.1:2e5]
+set xtics auto
+set ytics auto
+set format x "10^{%L}"
+set format y "10^{%L}"
+plot \
+    "01_1d_random_walk/results/dat/x2_mean_ctrw_exp.dat" using ($1+1):2 every 97 with points ls 3 ps 1.5 title "exponential", \
+    "01_1d_random_walk/results/dat/x2_mean_ctrw_pareto.dat" using ($1+1):2 every 97 with points ls 1 ps 1.5 title "Pareto {/Symbol a}=0.5", \
+    x with lines title "t" lc rgb "#333333" dashtype 2 lw 3, \
+    2/pi*sqrt(x) with lines title "(2/{/Symbol p}) t^{1/2}" lc rgb "#333333" lw 3
+unset format
+
+# Plot 14: Levy flights (alpha = 1.5), quantiles of the distance
+set output 'plots/plot14_levy_quantiles.png'
+# set title "Levy flight quantiles"
+set xlabel "t"
+set ylabel "quantiles of |x|, |r|"
+set logscale xy
+set xrange [1:1e5]
+set yrange [0.5:1e5]
+set xtics auto
+set ytics auto
+set format x "10^{%L}"
+set format y "10^{%L}"
+plot \
+    "01_1d_random_walk/results/dat/levy_1d.dat" using 1:5 with points ls 1 ps 1.5 title "1D median", \
+    "01_1d_random_walk/results/dat/levy_1d.dat" using 1:7 with points ls 3 ps 1.5 title "1D 90%", \
+    "02_2d_random_walk/results/dat/2d_levy.dat" using 1:5 with points ls 4 ps 1.5 title "2D median", \
+    "01_1d_random_walk/results/dat/levy_1d.dat" using 1:8 with lines lw 3.0 lc rgb "#333333" dashtype 2 title "t^{1/{/Symbol a}}"
+unset format
+
+# Plot 15: return probability of walks on 10^6-node graphs (even t)
+set output 'plots/plot15_graph_return.png'
+# set title "P_0(t) on graphs"
+set xlabel "t"
+set ylabel "P_0(t)"
+set logscale xy
+set xrange [2:1000]
+set yrange [1e-6:1]
+set xtics auto
+set ytics auto
+set format x "10^{%L}"
+set format y "10^{%L}"
+plot \
+    "07_graph_walks/results/dat/graph_lattice_return.dat" using 1:(int($1) % 2 == 0 ? $2 : 1/0) with points ls 1 ps 1.5 title "torus 1000^2", \
+    "07_graph_walks/results/dat/graph_smallworld_return.dat" using 1:(int($1) % 2 == 0 ? $2 : 1/0) with points ls 3 ps 1.5 title "small world k=2, p=0.1", \
+    "07_graph_walks/results/dat/graph_regular_return.dat" using 1:(int($1) % 2 == 0 ? $2 : 1/0) with points ls 4 ps 1.5 title "3-regular", \
+    2/(pi*x) with lines lw 3.0 lc rgb "#333333" title "2/({/Symbol p}t)"
+unset format
+
+# Plot 16: TASEP steady current, parallel update on the ring
+set output 'plots/plot16_tasep_current.png'
+# set title "TASEP current J({/Symbol r})"
+set xlabel "{/Symbol r}"
+set ylabel "J"
+unset logscale
+set xrange [0:1]
+set yrange [0:0.3]
+set xtics auto
+set ytics auto
+J(r, p) = 0.5 * (1 - sqrt(1 - 4 * p * r * (1 - r)))
+plot \
+    "08_tasep_ring/results/dat/tasep_p0.5_current.dat" using 2:4:5 with yerrorbars ls 1 ps 1.5 title "p = 0.5", \
+    "08_tasep_ring/results/dat/tasep_p0.75_current.dat" using 2:4:5 with yerrorbars ls 3 ps 1.5 title "p = 0.75", \
+    J(x, 0.5) with lines lw 3.0 lc rgb "#333333" title "exact", \
+    J(x, 0.75) with lines lw 3.0 lc rgb "#333333" notitle
+
+# Plot 17: single-file diffusion, tracer <Dx^2(t)> against Arratia's law
+set output 'plots/plot17_single_file.png'
+# set title "Single-file diffusion"
+set xlabel "t"
+set ylabel "<{/Symbol D}x^2(t)>"
+set logscale xy
+set xrange [1:1e6]
+set yrange [0.3:1e4]
+set xtics auto
+set ytics auto
+set format x "10^{%L}"
+set format y "10^{%L}"
+A(r) = (1 - r) / r * sqrt(2 / pi)
+plot \
+    "09_single_file_diffusion/results/dat/sfd_rho0.2_msd.dat" using 1:2:3 with yerrorbars ls 1 ps 1.5 title "{/Symbol r} = 0.2", \
+    "09_single_file_diffusion/results/dat/sfd_rho0.5_msd.dat" using 1:2:3 with yerrorbars ls 3 ps 1.5 title "{/Symbol r} = 0.5", \
+    A(0.2) * sqrt(x) with lines lw 3.0 lc rgb "#333333" title "(1-{/Symbol r})/{/Symbol r} (2t/{/Symbol p})^{1/2}", \
+    A(0.5) * sqrt(x) with lines lw 3.0 lc rgb "#333333" notitle, \
+    x with lines lw 2.0 dt 2 lc rgb "#888888" title "free particle"
+unset format